@@ -9,16 +9,42 @@ namespace aic3204 {
 
 static const char *const TAG = "aic3204";
 
+// Runs on the I2C scheduler task, so it only logs; the completion callback marks the component failed
 #define ERROR_CHECK(err, msg) \
   if (!err) { \
     ESP_LOGE(TAG, msg); \
-    this->mark_failed(); \
-    return; \
+    return false; \
   }
 
 void AIC3204::setup() {
   ESP_LOGCONFIG(TAG, "Setting up AIC3204...");
 
+  this->submit_i2c_(
+      i2c_scheduler::Priority::BULK, [this]() { return this->write_setup_registers_(); },
+      [this](bool success) {
+        if (!success) {
+          this->mark_failed();
+          return;
+        }
+        // Wait for 2.5 sec for soft stepping to take effect before attempting power-up
+        this->set_timeout(2500, [this]() {
+          this->submit_i2c_(
+              i2c_scheduler::Priority::BULK, [this]() { return this->write_power_up_registers_(); },
+              [this](bool success) {
+                if (!success) {
+                  this->mark_failed();
+                  return;
+                }
+                // The software reset cleared any volume or mute written before now, so write the current values.
+                // Later changes queue behind these in the same queue, so the newest value always lands last.
+                this->set_volume(this->volume_);
+                this->submit_mute_();
+              });
+        });
+      });
+}
+
+bool AIC3204::write_setup_registers_() {
   // Set register page to 0
   ERROR_CHECK(this->write_byte(AIC3204_PAGE_CTRL, 0x00), "Set page 0 failed");
   // Initiate SW reset (PLL is powered off as part of reset)
@@ -93,19 +119,18 @@ void AIC3204::setup() {
   // Power up HPL and HPR, LOL and LOR drivers
   ERROR_CHECK(this->write_byte(AIC3204_OP_PWR_CTRL, 0x3C), "Set OP_PWR_CTRL failed");
 
-  // Wait for 2.5 sec for soft stepping to take effect before attempting power-up
-  this->set_timeout(2500, [this]() {
-    // *** Power Up DAC ***
-    // Select Page 0
-    ERROR_CHECK(this->write_byte(AIC3204_PAGE_CTRL, 0x00), "Set PAGE_CTRL failed");
-    // Power up the Left and Right DAC Channels. Route Left data to Left DAC and Right data to Right DAC.
-    // DAC Vol control soft step 1 step per DAC word clock.
-    ERROR_CHECK(this->write_byte(AIC3204_DAC_CH_SET1, 0xd4), "Set DAC_CH_SET1 failed");
-    // Set left and right DAC digital volume control
-    ERROR_CHECK(this->write_volume_(), "Set volume failed");
-    // Unmute left and right channels
-    ERROR_CHECK(this->write_mute_(), "Set mute failed");
-  });
+  return true;
+}
+
+bool AIC3204::write_power_up_registers_() {
+  // *** Power Up DAC ***
+  // Select Page 0
+  ERROR_CHECK(this->write_byte(AIC3204_PAGE_CTRL, 0x00), "Set PAGE_CTRL failed");
+  // Power up the Left and Right DAC Channels. Route Left data to Left DAC and Right data to Right DAC.
+  // DAC Vol control soft step 1 step per DAC word clock.
+  ERROR_CHECK(this->write_byte(AIC3204_DAC_CH_SET1, 0xd4), "Set DAC_CH_SET1 failed");
+
+  return true;
 }
 
 void AIC3204::dump_config() {
@@ -119,23 +144,62 @@ void AIC3204::dump_config() {
 
 bool AIC3204::set_mute_off() {
   this->is_muted_ = false;
-  return this->write_mute_();
+  return this->submit_mute_();
 }
 
 bool AIC3204::set_mute_on() {
   this->is_muted_ = true;
-  return this->write_mute_();
+  return this->submit_mute_();
 }
 
 bool AIC3204::set_auto_mute_mode(uint8_t auto_mute_mode) {
   this->auto_mute_mode_ = auto_mute_mode & 0x07;
   ESP_LOGVV(TAG, "Setting auto_mute_mode to 0x%.2x", this->auto_mute_mode_);
-  return this->write_mute_();
+  return this->submit_mute_();
 }
 
 bool AIC3204::set_volume(float volume) {
   this->volume_ = clamp<float>(volume, 0.0, 1.0);
-  return this->write_volume_();
+  const int8_t volume_byte = this->volume_byte_();
+  ESP_LOGVV(TAG, "Setting volume to 0x%.2x", volume_byte & 0xFF);
+  return this->submit_i2c_(i2c_scheduler::Priority::URGENT,
+                           [this, volume_byte]() { return this->write_volume_(volume_byte); });
+}
+
+bool AIC3204::set_standby(bool standby, std::function<void(bool)> &&on_complete) {
+  this->is_in_standby_ = standby;
+  ESP_LOGD(TAG, "%s output stages", standby ? "Powering down" : "Powering up");
+  const bool queued = this->submit_i2c_(
+      i2c_scheduler::Priority::URGENT, [this, standby]() { return this->write_standby_(standby); },
+      [on_complete](bool success) {
+        if (on_complete != nullptr) {
+          on_complete(success);
+        }
+      });
+  if (!queued && (on_complete != nullptr)) {
+    on_complete(false);
+  }
+  return queued;
+}
+
+bool AIC3204::submit_mute_() {
+  const uint8_t mute_mode_byte = this->mute_mode_byte_();
+  return this->submit_i2c_(i2c_scheduler::Priority::URGENT,
+                           [this, mute_mode_byte]() { return this->write_mute_(mute_mode_byte); });
+}
+
+uint8_t AIC3204::mute_mode_byte_() {
+  uint8_t mute_mode_byte = this->auto_mute_mode_ << 4;  // auto-mute control is bits 4-6
+  mute_mode_byte |= this->is_muted_ ? 0x0c : 0x00;      // mute bits are 2-3
+  return mute_mode_byte;
+}
+
+int8_t AIC3204::volume_byte_() {
+  const int8_t dvc_min_byte = -127;
+  const int8_t dvc_max_byte = 48;
+
+  int8_t volume_byte = dvc_min_byte + (this->volume_ * (dvc_max_byte - dvc_min_byte));
+  return clamp<int8_t>(volume_byte, dvc_min_byte, dvc_max_byte);
 }
 
 bool AIC3204::is_muted() {
@@ -146,9 +210,7 @@ float AIC3204::volume() {
   return this->volume_;
 }
 
-bool AIC3204::write_mute_() {
-  uint8_t mute_mode_byte = this->auto_mute_mode_ << 4;  // auto-mute control is bits 4-6
-  mute_mode_byte |= this->is_muted_ ? 0x0c : 0x00;      // mute bits are 2-3
+bool AIC3204::write_mute_(uint8_t mute_mode_byte) {
   if (!this->write_byte(AIC3204_PAGE_CTRL, 0x00) || !this->write_byte(AIC3204_DAC_CH_SET2, mute_mode_byte)) {
     ESP_LOGE(TAG, "Writing mute modes failed");
     return false;
@@ -156,15 +218,27 @@ bool AIC3204::write_mute_() {
   return true;
 }
 
-bool AIC3204::write_volume_() {
-  const int8_t dvc_min_byte = -127;
-  const int8_t dvc_max_byte = 48;
-
-  int8_t volume_byte = dvc_min_byte + (this->volume_ * (dvc_max_byte - dvc_min_byte));
-  volume_byte = clamp<int8_t>(volume_byte, dvc_min_byte, dvc_max_byte);
-
-  ESP_LOGVV(TAG, "Setting volume to 0x%.2x", volume_byte & 0xFF);
+bool AIC3204::write_standby_(bool standby) {
+  if (standby) {
+    // Power down the Left and Right DAC channels first, keeping the data routing, to avoid pops
+    // Then power down the HPL, HPR, LOL, and LOR drivers
+    if (!this->write_byte(AIC3204_PAGE_CTRL, 0x00) || !this->write_byte(AIC3204_DAC_CH_SET1, 0x14) ||
+        !this->write_byte(AIC3204_PAGE_CTRL, 0x01) || !this->write_byte(AIC3204_OP_PWR_CTRL, 0x00)) {
+      ESP_LOGE(TAG, "Writing standby mode failed");
+      return false;
+    }
+  } else {
+    // Power up the HPL, HPR, LOL, and LOR drivers, then the Left and Right DAC channels (same as in setup)
+    if (!this->write_byte(AIC3204_PAGE_CTRL, 0x01) || !this->write_byte(AIC3204_OP_PWR_CTRL, 0x3C) ||
+        !this->write_byte(AIC3204_PAGE_CTRL, 0x00) || !this->write_byte(AIC3204_DAC_CH_SET1, 0xd4)) {
+      ESP_LOGE(TAG, "Writing standby mode failed");
+      return false;
+    }
+  }
+  return true;
+}
 
+bool AIC3204::write_volume_(int8_t volume_byte) {
   if ((!this->write_byte(AIC3204_PAGE_CTRL, 0x00)) || (!this->write_byte(AIC3204_DACL_VOL_D, volume_byte)) ||
       (!this->write_byte(AIC3204_DACR_VOL_D, volume_byte))) {
     ESP_LOGE(TAG, "Writing volume failed");
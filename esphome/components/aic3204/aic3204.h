@@ -2,6 +2,7 @@
 
 #include "esphome/components/audio_dac/audio_dac.h"
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/components/i2c_scheduler/i2c_scheduler.h"
 #include "esphome/core/component.h"
 #include "esphome/core/defines.h"
 #include "esphome/core/hal.h"
@@ -62,7 +63,12 @@ static const uint8_t AIC3204_ADC_PTM = 0x3D;       // Register 61 - ADC Power Tu
 static const uint8_t AIC3204_AN_IN_CHRG = 0x47;    // Register 71 - Analog Input Quick Charging Config
 static const uint8_t AIC3204_REF_STARTUP = 0x7B;   // Register 123 - Reference Power Up Config
 
-class AIC3204 : public audio_dac::AudioDac, public Component, public i2c::I2CDevice {
+// Every register write runs on the I2C scheduler's task. The setters queue the write and return whether it was
+// queued; volume and mute changes go in the urgent queue so they aren't held up by other traffic on the bus.
+class AIC3204 : public audio_dac::AudioDac,
+                public Component,
+                public i2c::I2CDevice,
+                public i2c_scheduler::ScheduledDevice {
  public:
   void setup() override;
   void dump_config() override;
@@ -72,13 +78,22 @@ class AIC3204 : public audio_dac::AudioDac, public Component, public i2c::I2CDev
   bool set_mute_on() override;
   bool set_auto_mute_mode(uint8_t auto_mute_mode);
   bool set_volume(float volume) override;
+  bool set_standby(bool standby, std::function<void(bool)> &&on_complete = nullptr) override;
 
   bool is_muted() override;
   float volume() override;
 
  protected:
-  bool write_mute_();
-  bool write_volume_();
+  bool submit_mute_();
+  uint8_t mute_mode_byte_();
+  int8_t volume_byte_();
+
+  // These run on the I2C scheduler task, so they only access the bus and the values passed in
+  bool write_setup_registers_();
+  bool write_power_up_registers_();
+  bool write_mute_(uint8_t mute_mode_byte);
+  bool write_standby_(bool standby);
+  bool write_volume_(int8_t volume_byte);
 
   uint8_t auto_mute_mode_{0};
   float volume_{0};
@@ -1,5 +1,5 @@
 import esphome.codegen as cg
-from esphome.components import i2c
+from esphome.components import i2c, i2c_scheduler
 import esphome.config_validation as cv
 from esphome import automation
 from esphome.components.audio_dac import AudioDac, audio_dac_ns
@@ -7,9 +7,16 @@ from esphome.const import CONF_ID, CONF_MODE
 
 CODEOWNERS = ["@kbx81"]
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["i2c_scheduler"]
 
 aic3204_ns = cg.esphome_ns.namespace("aic3204")
-AIC3204 = aic3204_ns.class_("AIC3204", AudioDac, cg.Component, i2c.I2CDevice)
+AIC3204 = aic3204_ns.class_(
+    "AIC3204",
+    AudioDac,
+    cg.Component,
+    i2c.I2CDevice,
+    i2c_scheduler.ScheduledDevice,
+)
 
 SetAutoMuteAction = aic3204_ns.class_("SetAutoMuteAction", automation.Action)
 
@@ -50,3 +57,4 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
+    await i2c_scheduler.register_scheduled_device(var, config)
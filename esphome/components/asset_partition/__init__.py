@@ -0,0 +1,110 @@
+"""Asset partition: keeps sound files and wake word models in a data partition instead of the app image.
+
+When ``asset_partition:`` is in the configuration, ``nabu`` media files and ``micro_wake_word`` models are registered
+here instead of being compiled in as C arrays. The partition image is written to the build directory and must be
+flashed to a data partition labelled ``assets`` (e.g., with ``parttool.py``). App OTAs then only carry code, and the
+assets can be rewritten without rebuilding the app as long as their names don't change.
+
+Image layout (little endian):
+  - Header: magic ``ASET``, uint16 version, uint16 asset count, uint32 image size
+  - Index: per asset, a 48 byte NUL padded name, uint32 offset from the image start, and uint32 length
+  - Asset data, each aligned to 16 bytes so TFLite models can be used in place
+"""
+
+import logging
+from pathlib import Path
+import struct
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.core import CORE, EsphomeError
+from esphome.coroutine import coroutine_with_priority
+
+_LOGGER = logging.getLogger(__name__)
+
+DOMAIN = "asset_partition"
+
+PARTITION_LABEL = "assets"
+IMAGE_FILENAME = "assets.bin"
+
+IMAGE_MAGIC = b"ASET"
+IMAGE_VERSION = 1
+NAME_LENGTH = 48
+DATA_ALIGNMENT = 16
+
+_HEADER = struct.Struct("<4sHHI")
+_INDEX_ENTRY = struct.Struct(f"<{NAME_LENGTH}sII")
+
+asset_partition_ns = cg.esphome_ns.namespace("asset_partition")
+get_asset = asset_partition_ns.get_asset
+load_asset = asset_partition_ns.load_asset
+
+CONFIG_SCHEMA = cv.All(cv.Schema({}), cv.only_with_esp_idf)
+
+
+def is_enabled() -> bool:
+    """Returns True if assets should be stored in the partition instead of the app image."""
+    return DOMAIN in CORE.config
+
+
+def _registered_assets() -> dict:
+    return CORE.data.setdefault(DOMAIN, {})
+
+
+def add_asset(name: str, data: bytes) -> str:
+    """Adds an asset to the partition image and returns the name to look it up with at runtime."""
+    if len(name.encode()) >= NAME_LENGTH:
+        raise EsphomeError(
+            f"Asset name '{name}' is too long; it must be under {NAME_LENGTH} bytes"
+        )
+    assets = _registered_assets()
+    if assets.get(name, data) != data:
+        raise EsphomeError(f"Two different assets are named '{name}'")
+    assets[name] = bytes(data)
+    return name
+
+
+def _align(value: int) -> int:
+    return (value + DATA_ALIGNMENT - 1) // DATA_ALIGNMENT * DATA_ALIGNMENT
+
+
+def build_image(assets: dict) -> bytes:
+    """Packs the assets into a partition image."""
+    data_start = _HEADER.size + _INDEX_ENTRY.size * len(assets)
+
+    index = bytearray()
+    data = bytearray()
+    for name, content in assets.items():
+        data += bytes(_align(data_start + len(data)) - data_start - len(data))
+        index += _INDEX_ENTRY.pack(name.encode(), data_start + len(data), len(content))
+        data += content
+
+    image_size = _HEADER.size + len(index) + len(data)
+    return _HEADER.pack(IMAGE_MAGIC, IMAGE_VERSION, len(assets), image_size) + index + data
+
+
+@coroutine_with_priority(-1000.0)
+async def _write_image():
+    # Runs after every component has registered its assets
+    assets = _registered_assets()
+    image = build_image(assets)
+
+    path = Path(CORE.relative_build_path(IMAGE_FILENAME))
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_bytes(image)
+
+    _LOGGER.info(
+        "Wrote %d assets (%d bytes) to %s. Flash it to the '%s' partition with: "
+        "parttool.py write_partition --partition-name %s --input %s",
+        len(assets),
+        len(image),
+        path,
+        PARTITION_LABEL,
+        PARTITION_LABEL,
+        path,
+    )
+
+
+async def to_code(config):
+    cg.add_define("USE_ASSET_PARTITION")
+    CORE.add_job(_write_image)
@@ -0,0 +1,116 @@
+#ifdef USE_ESP_IDF
+
+#include "asset_partition.h"
+
+#include "esphome/core/log.h"
+
+#include <esp_partition.h>
+
+#include <cstring>
+
+namespace esphome {
+namespace asset_partition {
+
+static const char *const TAG = "asset_partition";
+
+static const char *const PARTITION_LABEL = "assets";
+
+static const char IMAGE_MAGIC[4] = {'A', 'S', 'E', 'T'};
+static const uint16_t IMAGE_VERSION = 1;
+static const size_t NAME_LENGTH = 48;
+
+struct __attribute__((packed)) ImageHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t asset_count;
+  uint32_t image_size;
+};
+
+struct __attribute__((packed)) IndexEntry {
+  char name[NAME_LENGTH];  // NUL padded
+  uint32_t offset;         // From the start of the image
+  uint32_t length;
+};
+
+static const uint8_t *map_image() {
+  static bool attempted = false;
+  static const uint8_t *image = nullptr;
+
+  if (attempted) {
+    return image;
+  }
+  attempted = true;
+
+  const esp_partition_t *partition =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, PARTITION_LABEL);
+  if (partition == nullptr) {
+    ESP_LOGE(TAG, "No '%s' data partition found", PARTITION_LABEL);
+    return nullptr;
+  }
+
+  // Check the header before mapping so only the used part of the partition takes up MMU pages
+  ImageHeader header;
+  if (esp_partition_read(partition, 0, &header, sizeof(header)) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to read the '%s' partition", PARTITION_LABEL);
+    return nullptr;
+  }
+  if ((memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0) || (header.version != IMAGE_VERSION) ||
+      (header.image_size > partition->size) ||
+      (header.image_size < sizeof(ImageHeader) + header.asset_count * sizeof(IndexEntry))) {
+    ESP_LOGE(TAG, "The '%s' partition doesn't hold a valid asset image", PARTITION_LABEL);
+    return nullptr;
+  }
+
+  const void *mapped;
+  esp_partition_mmap_handle_t handle;  // Never unmapped
+  if (esp_partition_mmap(partition, 0, header.image_size, ESP_PARTITION_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to map the '%s' partition", PARTITION_LABEL);
+    return nullptr;
+  }
+
+  ESP_LOGD(TAG, "Mapped %u assets (%" PRIu32 " bytes)", header.asset_count, header.image_size);
+  image = static_cast<const uint8_t *>(mapped);
+  return image;
+}
+
+const uint8_t *get_asset(const char *name, size_t *length) {
+  if (length != nullptr) {
+    *length = 0;
+  }
+
+  const uint8_t *image = map_image();
+  if (image == nullptr) {
+    return nullptr;
+  }
+
+  const ImageHeader *header = reinterpret_cast<const ImageHeader *>(image);
+  const IndexEntry *index = reinterpret_cast<const IndexEntry *>(image + sizeof(ImageHeader));
+
+  for (uint16_t i = 0; i < header->asset_count; ++i) {
+    const IndexEntry &entry = index[i];
+    if (strncmp(entry.name, name, NAME_LENGTH) != 0) {
+      continue;
+    }
+    if ((entry.offset > header->image_size) || (entry.length > header->image_size - entry.offset)) {
+      ESP_LOGE(TAG, "Asset '%s' extends past the end of the image", name);
+      return nullptr;
+    }
+    if (length != nullptr) {
+      *length = entry.length;
+    }
+    return image + entry.offset;
+  }
+
+  ESP_LOGE(TAG, "Asset '%s' isn't in the '%s' partition", name, PARTITION_LABEL);
+  return nullptr;
+}
+
+bool load_asset(const char *name, const uint8_t *&data, size_t &length) {
+  data = get_asset(name, &length);
+  return data != nullptr;
+}
+
+}  // namespace asset_partition
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace asset_partition {
+
+// Read-only store of named assets kept in the ``assets`` data partition instead of the app image
+//  - ``__init__.py`` builds the partition image: a small index followed by the asset data
+//  - The used part of the partition is memory mapped on the first lookup, so assets are read straight from flash just
+//    like data compiled into the app
+//  - Lookups are by name, so the partition can be rewritten without an app OTA as long as the names stay the same
+//  - Lookups happen while the generated code constructs components, before any tasks start, so they aren't locked
+
+/// @brief Looks up an asset by name
+/// @param name Name the asset was registered with at compile time
+/// @param length Set to the asset's size in bytes, or 0 if it isn't found. May be nullptr.
+/// @return Pointer to the asset in mapped flash (aligned to 16 bytes), or nullptr if the partition or asset is missing
+const uint8_t *get_asset(const char *name, size_t *length = nullptr);
+
+/// @brief Looks up an asset by name and stores its location in existing fields, e.g., a ``MediaFile``'s
+/// @param name Name the asset was registered with at compile time
+/// @param data Set to the asset's address in mapped flash, or nullptr if it isn't found
+/// @param length Set to the asset's size in bytes, or 0 if it isn't found
+/// @return True if the asset was found
+bool load_asset(const char *name, const uint8_t *&data, size_t &length);
+
+}  // namespace asset_partition
+}  // namespace esphome
+
+#endif
@@ -3,6 +3,8 @@
 #include "esphome/core/defines.h"
 #include "esphome/core/hal.h"
 
+#include <functional>
+
 namespace esphome {
 namespace audio_dac {
 
@@ -15,8 +17,24 @@ class AudioDac {
   virtual bool is_muted() = 0;
   virtual float volume() = 0;
 
+  /// @brief Powers down (or back up) the DAC's output stages while no audio is playing. DACs that don't support
+  /// standby leave their outputs powered.
+  /// @param standby If true, the output stages are powered down. If false, they are powered up.
+  /// @param on_complete Called from the main loop once the output stages are in the requested state, with whether
+  /// the change succeeded. DACs that write asynchronously call it after returning. May be nullptr.
+  /// @return true if the change was started, false otherwise
+  virtual bool set_standby(bool standby, std::function<void(bool)> &&on_complete = nullptr) {
+    if (on_complete != nullptr) {
+      on_complete(true);  // The outputs are always powered
+    }
+    return false;
+  }
+
+  bool is_in_standby() const { return this->is_in_standby_; }
+
  protected:
   bool is_muted_{false};
+  bool is_in_standby_{false};
 };
 
 }  // namespace aic3204
@@ -0,0 +1,31 @@
+"""I2C scheduler: runs every transaction for the devices on an I2C bus from one task.
+
+It isn't configured in YAML, so it has no CONFIG_SCHEMA. A device that supports it (ESP32 only) auto-loads this
+component and calls ``register_scheduled_device`` from its ``to_code``; the first device on each bus creates that bus's
+scheduler, and later ones share it.
+"""
+
+import esphome.codegen as cg
+from esphome.const import CONF_ID, CONF_I2C_ID
+from esphome.core import CORE, ID
+
+DEPENDENCIES = ["i2c"]
+
+DOMAIN = "i2c_scheduler"
+
+i2c_scheduler_ns = cg.esphome_ns.namespace("i2c_scheduler")
+I2CScheduler = i2c_scheduler_ns.class_("I2CScheduler", cg.Component)
+ScheduledDevice = i2c_scheduler_ns.class_("ScheduledDevice")
+
+
+async def register_scheduled_device(var, config):
+    """Runs the device's I2C transactions on the scheduler for its bus, creating the scheduler if needed."""
+    schedulers = CORE.data.setdefault(DOMAIN, {})
+    bus_id = str(config[CONF_I2C_ID])
+    if (scheduler := schedulers.get(bus_id)) is None:
+        scheduler = cg.new_Pvariable(
+            ID(f"{bus_id}_scheduler", is_declaration=True, type=I2CScheduler)
+        )
+        await cg.register_component(scheduler, {})
+        schedulers[bus_id] = scheduler
+    cg.add(var.set_i2c_scheduler(scheduler, str(config[CONF_ID])))
@@ -0,0 +1,163 @@
+#include "i2c_scheduler.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+namespace esphome {
+namespace i2c_scheduler {
+
+static const char *const TAG = "i2c_scheduler";
+
+static const size_t QUEUE_LENGTHS[PRIORITY_COUNT] = {8, 4, 4};
+static const size_t COMPLETED_QUEUE_LENGTH = 16;
+
+static const uint32_t TASK_STACK_SIZE = 3072;
+static const UBaseType_t TASK_PRIORITY = 6;
+
+static const uint32_t STATS_LOG_INTERVAL_MS = 60000;
+
+I2CScheduler::I2CScheduler() {
+  // Created here so devices can queue transactions before setup(); the task runs them once it starts
+  for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+    this->queues_[i] = xQueueCreate(QUEUE_LENGTHS[i], sizeof(Transaction *));
+  }
+  this->completed_queue_ = xQueueCreate(COMPLETED_QUEUE_LENGTH, sizeof(Transaction *));
+}
+
+void I2CScheduler::setup() {
+  xTaskCreate(I2CScheduler::scheduler_task_, "i2c_scheduler", TASK_STACK_SIZE, (void *) this, TASK_PRIORITY,
+              &this->scheduler_task_handle_);
+  if (this->scheduler_task_handle_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create scheduler task");
+    this->mark_failed();
+  }
+}
+
+void I2CScheduler::dump_config() {
+  ESP_LOGCONFIG(TAG, "I2C Scheduler:");
+  for (const auto &stats : this->device_stats_) {
+    ESP_LOGCONFIG(TAG, "  Device: %s", stats.name.c_str());
+  }
+}
+
+uint8_t I2CScheduler::register_device(const std::string &name) {
+  DeviceStats stats;
+  stats.name = name;
+  this->device_stats_.push_back(stats);
+  return this->device_stats_.size() - 1;
+}
+
+bool I2CScheduler::submit(uint8_t device, Priority priority, std::function<bool()> &&transfer,
+                          std::function<void(bool)> &&on_complete) {
+  const QueueHandle_t queue = this->queues_[static_cast<uint8_t>(priority)];
+  if ((queue == nullptr) || this->is_failed()) {
+    ESP_LOGE(TAG, "%s: scheduler isn't running; dropping transaction", this->device_stats_[device].name.c_str());
+    return false;
+  }
+
+  Transaction *transaction = new Transaction();
+  transaction->device = device;
+  transaction->transfer = std::move(transfer);
+  transaction->on_complete = std::move(on_complete);
+  transaction->submitted_us = micros();
+
+  if (xQueueSend(queue, &transaction, 0) != pdTRUE) {
+    ESP_LOGW(TAG, "%s: transaction queue is full", this->device_stats_[device].name.c_str());
+    delete transaction;
+    return false;
+  }
+  if (this->scheduler_task_handle_ != nullptr) {
+    xTaskNotifyGive(this->scheduler_task_handle_);
+  } else {
+    ESP_LOGV(TAG, "%s: queued a transaction before the scheduler task started",
+             this->device_stats_[device].name.c_str());
+  }
+  return true;
+}
+
+void I2CScheduler::scheduler_task_(void *params) {
+  I2CScheduler *this_scheduler = (I2CScheduler *) params;
+
+  // Transactions queued before the task started are in the queues already, so check them before sleeping
+
+  while (true) {
+    Transaction *transaction = nullptr;
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+      if (xQueueReceive(this_scheduler->queues_[i], &transaction, 0) == pdTRUE) {
+        break;
+      }
+    }
+
+    if (transaction == nullptr) {
+      // Every queue is empty; sleep until the next submit
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+
+    I2CScheduler::run_(transaction);
+    xQueueSend(this_scheduler->completed_queue_, &transaction, portMAX_DELAY);
+  }
+}
+
+void I2CScheduler::run_(Transaction *transaction) {
+  transaction->started_us = micros();
+  transaction->success = transaction->transfer();
+  transaction->finished_us = micros();
+}
+
+void I2CScheduler::loop() {
+  Transaction *transaction;
+  while ((this->completed_queue_ != nullptr) && (xQueueReceive(this->completed_queue_, &transaction, 0) == pdTRUE)) {
+    this->complete_(transaction);
+  }
+
+  const uint32_t now = millis();
+  if (now - this->last_stats_log_ms_ > STATS_LOG_INTERVAL_MS) {
+    this->last_stats_log_ms_ = now;
+    this->log_stats_();
+  }
+}
+
+void I2CScheduler::complete_(Transaction *transaction) {
+  DeviceStats &stats = this->device_stats_[transaction->device];
+  const uint32_t wait_us = transaction->started_us - transaction->submitted_us;
+  const uint32_t transfer_us = transaction->finished_us - transaction->started_us;
+
+  ++stats.transactions;
+  if (!transaction->success) {
+    ++stats.failures;
+  }
+  stats.total_wait_us += wait_us;
+  stats.total_transfer_us += transfer_us;
+  stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+  stats.max_transfer_us = std::max(stats.max_transfer_us, transfer_us);
+
+  if (transaction->on_complete != nullptr) {
+    transaction->on_complete(transaction->success);
+  }
+  delete transaction;
+}
+
+void I2CScheduler::log_stats_() {
+  for (const auto &stats : this->device_stats_) {
+    if (stats.transactions == 0) {
+      continue;
+    }
+    ESP_LOGV(TAG,
+             "%s: %" PRIu32 " transactions, %" PRIu32 " failed; wait avg %" PRIu32 " us, max %" PRIu32
+             " us; transfer avg %" PRIu32 " us, max %" PRIu32 " us",
+             stats.name.c_str(), stats.transactions, stats.failures,
+             static_cast<uint32_t>(stats.total_wait_us / stats.transactions), stats.max_wait_us,
+             static_cast<uint32_t>(stats.total_transfer_us / stats.transactions), stats.max_transfer_us);
+  }
+}
+
+}  // namespace i2c_scheduler
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "esphome/core/component.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace i2c_scheduler {
+
+// Runs every transaction for the devices on one I2C bus from a single task
+//  - Devices submit a transfer function along with a priority. The task runs the transfers one at a time, always
+//    taking the next one from the most urgent non-empty queue, so a long transfer never interleaves with another
+//    device's and a backlog of bulk transfers doesn't delay a volume change by more than one transfer.
+//  - Completion callbacks run in the scheduler's loop(), so they can safely call into other components and
+//    automations. Transfer functions run on the scheduler task, so they must only access the bus and the device's
+//    own state.
+//  - The time each transaction waits in its queue and spends on the bus is tracked per device
+
+enum class Priority : uint8_t {
+  URGENT = 0,     // User facing changes, e.g., volume and mute
+  BULK = 1,       // Large transfers that can take a while, e.g., firmware update blocks
+  TELEMETRY = 2,  // Periodic status reads
+};
+
+static const size_t PRIORITY_COUNT = 3;
+
+struct Transaction {
+  uint8_t device;
+  std::function<bool()> transfer;
+  std::function<void(bool)> on_complete;
+  uint32_t submitted_us;
+  uint32_t started_us;
+  uint32_t finished_us;
+  bool success;
+};
+
+struct DeviceStats {
+  std::string name;
+  uint32_t transactions{0};
+  uint32_t failures{0};
+  uint64_t total_wait_us{0};
+  uint64_t total_transfer_us{0};
+  uint32_t max_wait_us{0};
+  uint32_t max_transfer_us{0};
+};
+
+class I2CScheduler : public Component {
+ public:
+  I2CScheduler();
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+  /// @brief Registers a device for latency tracking
+  /// @param name Name shown in the statistics
+  /// @return Handle to pass to submit()
+  uint8_t register_device(const std::string &name);
+
+  /// @brief Queues a transaction for the scheduler task. Transactions queued before setup() run once the task starts.
+  /// @param device Handle from register_device()
+  /// @param priority Queue the transaction waits in
+  /// @param transfer Performs the I2C transfers on the scheduler task; returns true on success
+  /// @param on_complete Called in loop() with the transfer's result. May be nullptr.
+  /// @return False if the queue is full or the task couldn't be created; the transaction is dropped and
+  /// on_complete isn't called
+  bool submit(uint8_t device, Priority priority, std::function<bool()> &&transfer,
+              std::function<void(bool)> &&on_complete = nullptr);
+
+ protected:
+  static void scheduler_task_(void *params);
+
+  /// @brief Runs the transaction on the calling task and records its timing
+  static void run_(Transaction *transaction);
+
+  /// @brief Updates the device's statistics and calls the transaction's completion callback
+  void complete_(Transaction *transaction);
+
+  void log_stats_();
+
+  TaskHandle_t scheduler_task_handle_{nullptr};
+  QueueHandle_t queues_[PRIORITY_COUNT]{};
+  QueueHandle_t completed_queue_{nullptr};
+
+  std::vector<DeviceStats> device_stats_;
+  uint32_t last_stats_log_ms_{0};
+};
+
+// Base for devices whose I2C transactions run on an I2CScheduler
+class ScheduledDevice {
+ public:
+  void set_i2c_scheduler(I2CScheduler *i2c_scheduler, const std::string &name) {
+    this->i2c_scheduler_ = i2c_scheduler;
+    this->i2c_scheduler_device_ = i2c_scheduler->register_device(name);
+  }
+
+ protected:
+  bool submit_i2c_(Priority priority, std::function<bool()> &&transfer,
+                   std::function<void(bool)> &&on_complete = nullptr) {
+    return this->i2c_scheduler_->submit(this->i2c_scheduler_device_, priority, std::move(transfer),
+                                        std::move(on_complete));
+  }
+
+  I2CScheduler *i2c_scheduler_{nullptr};
+  uint8_t i2c_scheduler_device_{0};
+};
+
+}  // namespace i2c_scheduler
+}  // namespace esphome
+
+#endif
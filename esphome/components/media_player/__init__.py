@@ -27,6 +27,7 @@ MEDIA_FILE_TYPE_ENUM = {
     "WAV": MediaFileType.WAV,
     "MP3": MediaFileType.MP3,
     "FLAC": MediaFileType.FLAC,
+    "QOA": MediaFileType.QOA,
 }
 
 
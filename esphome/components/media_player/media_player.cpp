@@ -56,6 +56,8 @@ const char *media_player_file_type_to_string(MediaFileType file_type) {
       return "MP3";
     case MediaFileType::WAV:
       return "WAV";
+    case MediaFileType::QOA:
+      return "QOA";
     default:
       return "unknonw";
   }
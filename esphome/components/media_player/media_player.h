@@ -32,6 +32,7 @@ enum class MediaFileType : uint8_t {
   WAV,
   MP3,
   FLAC,
+  QOA,
 };
 const char *media_player_file_type_to_string(MediaFileType file_type);
 
@@ -11,7 +11,7 @@ import esphome.codegen as cg
 
 from esphome.core import CORE, HexInt
 
-from esphome.components import esp32, microphone
+from esphome.components import asset_partition, esp32, microphone
 from esphome import automation, git, external_files
 from esphome.automation import register_action, register_condition
 
@@ -43,10 +43,12 @@ DEPENDENCIES = ["microphone"]
 DOMAIN = "micro_wake_word"
 
 
+CONF_COOLDOWN_PERIOD = "cooldown_period"
 CONF_FEATURE_STEP_SIZE = "feature_step_size"
 CONF_MODELS = "models"
 CONF_ON_WAKE_WORD_DETECTED = "on_wake_word_detected"
 CONF_PROBABILITY_CUTOFF = "probability_cutoff"
+CONF_REFRACTORY_PERIOD = "refractory_period"
 CONF_SLIDING_WINDOW_AVERAGE_SIZE = "sliding_window_average_size"
 CONF_SLIDING_WINDOW_SIZE = "sliding_window_size"
 CONF_TENSOR_ARENA_SIZE = "tensor_arena_size"
@@ -332,6 +334,7 @@ MODEL_SCHEMA = cv.Schema(
         cv.Optional(CONF_MODEL): MODEL_SOURCE_SCHEMA,
         cv.Optional(CONF_PROBABILITY_CUTOFF): cv.percentage,
         cv.Optional(CONF_SLIDING_WINDOW_SIZE): cv.positive_int,
+        cv.Optional(CONF_REFRACTORY_PERIOD): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_INTERNAL, default=False): cv.boolean,
         cv.GenerateID(CONF_RAW_DATA_ID): cv.declare_id(cg.uint8),
     }
@@ -370,6 +373,9 @@ CONFIG_SCHEMA = cv.All(
                 single=True
             ),
             cv.Optional(CONF_VAD): _maybe_empty_vad_schema,
+            cv.Optional(
+                CONF_COOLDOWN_PERIOD, default="0ms"
+            ): cv.positive_time_period_milliseconds,
             cv.Optional(CONF_MODEL): cv.invalid(
                 f"The {CONF_MODEL} parameter has moved to be a list element under the {CONF_MODELS} parameter."
             ),
@@ -424,18 +430,28 @@ def _model_config_to_manifest_data(model_config):
 
 
 def _feature_step_size_validate(config):
-    features_step_size = None
+    # The preprocessor computes the spectrum at the finest step size, and models with coarser steps use every n-th
+    # slice of it, so each step size must be a multiple of the finest
+    models = list(config[CONF_MODELS])
+    if vad_model := config.get(CONF_VAD):
+        models.append(vad_model)
 
-    for model_parameters in config[CONF_MODELS]:
+    step_sizes = []
+    for model_parameters in models:
         model_config = model_parameters.get(CONF_MODEL)
         manifest, _ = _model_config_to_manifest_data(model_config)
 
-        model_step_size = manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE]
+        step_size = manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE]
+        if step_size == 0:
+            raise cv.Invalid(f"Model {manifest[CONF_MODEL]} has a features step size of 0 ms.")
+        step_sizes.append(step_size)
 
-        if features_step_size is None:
-            features_step_size = model_step_size
-        elif features_step_size != model_step_size:
-            raise cv.Invalid("Cannot load models with different features step sizes.")
+    finest_step_size = min(step_sizes)
+    for step_size in step_sizes:
+        if step_size % finest_step_size != 0:
+            raise cv.Invalid(
+                f"Features step sizes must be multiples of the smallest step size ({finest_step_size} ms); got {step_size} ms."
+            )
 
 
 FINAL_VALIDATE_SCHEMA = _feature_step_size_validate
@@ -479,8 +495,15 @@ async def to_code(config):
         data = []
         manifest, data = _model_config_to_manifest_data(model_config)
 
-        rhs = [HexInt(x) for x in data]
-        prog_arr = cg.progmem_array(model_parameters[CONF_RAW_DATA_ID], rhs)
+        if asset_partition.is_enabled():
+            # Models are used in place from the mapped partition
+            asset_name = asset_partition.add_asset(
+                f"{DOMAIN}/{manifest[CONF_MODEL]}", data
+            )
+            prog_arr = asset_partition.get_asset(asset_name)
+        else:
+            rhs = [HexInt(x) for x in data]
+            prog_arr = cg.progmem_array(model_parameters[CONF_RAW_DATA_ID], rhs)
 
         probability_cutoff = model_parameters.get(
             CONF_PROBABILITY_CUTOFF, manifest[KEY_MICRO][CONF_PROBABILITY_CUTOFF]
@@ -499,6 +522,7 @@ async def to_code(config):
                     quantized_probability_cutoff,
                     sliding_window_size,
                     manifest[KEY_MICRO][CONF_TENSOR_ARENA_SIZE],
+                    manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE],
                 )
             )
         else:
@@ -519,9 +543,25 @@ async def to_code(config):
             for lang in manifest[KEY_TRAINED_LANGUAGES]:
                 cg.add(wake_word_model.add_trained_language(lang))
 
+            cg.add(
+                wake_word_model.set_features_step_size(
+                    manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE]
+                )
+            )
+
+            if refractory_period := model_parameters.get(CONF_REFRACTORY_PERIOD):
+                # The refractory period is counted in feature slices
+                step_size = max(manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE], 1)
+                refractory_slices = -(-refractory_period.total_milliseconds // step_size)
+                cg.add(
+                    wake_word_model.set_refractory_slices(
+                        min(refractory_slices, 65535)
+                    )
+                )
+
             cg.add(var.add_wake_word_model(wake_word_model))
 
-    cg.add(var.set_features_step_size(manifest[KEY_MICRO][CONF_FEATURE_STEP_SIZE]))
+    cg.add(var.set_cooldown_period(config[CONF_COOLDOWN_PERIOD]))
     cg.add_library("kahrendt/ESPMicroSpeechFeatures", "1.1.0")
 
 
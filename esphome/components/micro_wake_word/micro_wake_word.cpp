@@ -18,7 +18,9 @@
 #include <tensorflow/lite/micro/micro_interpreter.h>
 #include <tensorflow/lite/micro/micro_mutable_op_resolver.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace esphome {
 namespace micro_wake_word {
@@ -29,6 +31,9 @@ static const ssize_t DETECTION_QUEUE_COUNT = 5;
 
 static const ssize_t FEATURES_QUEUE_LENGTH = 10;
 
+// How often the preprocessor logs the time spent computing features
+static const uint32_t STATS_REPORT_INTERVAL_MS = 10000;
+
 // How long to block tasks while waiting for audio or spectrogram features data
 static const size_t DATA_TIMEOUT_MS = 50;
 static const size_t STOPPING_TIMEOUT_MS = 200;
@@ -47,6 +52,7 @@ enum EventGroupBits : uint32_t {
   PREPROCESSOR_MESSAGE_IDLE = (1 << 6),
   PREPROCESSOR_MESSAGE_ERROR = (1 << 7),
   PREPROCESSOR_MESSAGE_WARNING_FEATURES_FULL = (1 << 8),
+  PREPROCESSOR_MESSAGE_MUTED = (1 << 9),  // Set while the microphone is muted; no features are generated
 
   INFERENCE_MESSAGE_STARTED = (1 << 12),
   INFERENCE_MESSAGE_IDLE = (1 << 13),
@@ -55,6 +61,15 @@ enum EventGroupBits : uint32_t {
   ALL_BITS = 0xfffff,  // 24 total bits available in an event group
 };
 
+/// @brief Returns true if the first detection is more likely than the second. Compares the sliding window averages,
+/// then the maximum probabilities.
+static bool scores_higher(const DetectionEvent &first, const DetectionEvent &second) {
+  if (first.average_probability != second.average_probability) {
+    return first.average_probability > second.average_probability;
+  }
+  return first.max_probability > second.max_probability;
+}
+
 float MicroWakeWord::get_setup_priority() const { return setup_priority::AFTER_CONNECTION; }
 
 static const LogString *micro_wake_word_state_to_string(State state) {
@@ -70,6 +85,7 @@ static const LogString *micro_wake_word_state_to_string(State state) {
 
 void MicroWakeWord::dump_config() {
   ESP_LOGCONFIG(TAG, "microWakeWord:");
+  ESP_LOGCONFIG(TAG, "  Cooldown period: %" PRIu32 " ms", this->cooldown_period_ms_);
   ESP_LOGCONFIG(TAG, "  models:");
   for (auto &model : this->wake_word_models_) {
     model->log_model_config();
@@ -83,7 +99,6 @@ void MicroWakeWord::setup() {
   ESP_LOGCONFIG(TAG, "Setting up microWakeWord...");
 
   this->frontend_config_.window.size_ms = FEATURE_DURATION_MS;
-  this->frontend_config_.window.step_size_ms = this->features_step_size_;
   this->frontend_config_.filterbank.num_channels = PREPROCESSOR_FEATURE_SIZE;
   this->frontend_config_.filterbank.lower_band_limit = FILTERBANK_LOWER_BAND_LIMIT;
   this->frontend_config_.filterbank.upper_band_limit = FILTERBANK_UPPER_BAND_LIMIT;
@@ -98,11 +113,16 @@ void MicroWakeWord::setup() {
   this->frontend_config_.log_scale.enable_log = LOG_SCALE_ENABLE_LOG;
   this->frontend_config_.log_scale.scale_shift = LOG_SCALE_SCALE_SHIFT;
 
+  if (!this->setup_feature_streams_()) {
+    ESP_LOGE(TAG, "Failed to set up the spectrogram feature streams");
+    this->mark_failed();
+    return;
+  }
+  this->frontend_config_.window.step_size_ms = this->features_step_size_;
+
   this->event_group_ = xEventGroupCreate();
   this->detection_queue_ = xQueueCreate(DETECTION_QUEUE_COUNT, sizeof(DetectionEvent));
 
-  this->features_queue_ = xQueueCreate(FEATURES_QUEUE_LENGTH, PREPROCESSOR_FEATURE_SIZE * sizeof(int8_t));
-
   this->preprocessor_task_stack_buffer_ = (StackType_t *) malloc(PREPROCESSOR_TASK_STACK_SIZE);
   this->inference_task_stack_buffer_ = (StackType_t *) malloc(INFERENCE_TASK_STACK_SIZE);
 
@@ -141,18 +161,13 @@ void MicroWakeWord::preprocessor_task_(void *params) {
                            EventGroupBits::PREPROCESSOR_MESSAGE_ERROR | EventGroupBits::COMMAND_STOP);
       }
 
-      const size_t new_samples_to_read = this_mww->features_step_size_ * (AUDIO_SAMPLE_FREQUENCY / 1000);
-
-      ExternalRAMAllocator<int16_t> int16_allocator(ExternalRAMAllocator<int16_t>::ALLOW_FAILURE);
-
-      int8_t features_buffer[PREPROCESSOR_FEATURE_SIZE];
-      int16_t *audio_buffer = int16_allocator.allocate(new_samples_to_read);
-
-      if (audio_buffer == nullptr) {
+      if (!this_mww->populate_feature_streams_()) {
         xEventGroupSetBits(this_mww->event_group_,
                            EventGroupBits::PREPROCESSOR_MESSAGE_ERROR | EventGroupBits::COMMAND_STOP);
       }
 
+      const size_t new_samples_to_read = this_mww->new_samples_to_get_();
+
       if (this_mww->microphone_->is_stopped()) {
         this_mww->microphone_->start();
       }
@@ -161,57 +176,238 @@ void MicroWakeWord::preprocessor_task_(void *params) {
         xEventGroupSetBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_STARTED);
       }
 
+      uint32_t stats_windows = 0;
+      uint32_t stats_shared_us = 0;
+      uint32_t stats_last_report_ms = millis();
+
+      bool muted = false;
+
       while (!(xEventGroupGetBits(this_mww->event_group_) & COMMAND_STOP)) {
-        size_t bytes_read = this_mww->microphone_->read(audio_buffer, new_samples_to_read * sizeof(int16_t),
-                                                        pdMS_TO_TICKS(DATA_TIMEOUT_MS));
-        if (bytes_read < new_samples_to_read * sizeof(int16_t)) {
-          // This shouldn't ever happen, but if we somehow don't have enough samples, just drop this frame
+        if (this_mww->microphone_->get_mute_state()) {
+          if (!muted) {
+            ESP_LOGD(TAG, "Microphone muted; pausing wake word detection");
+            xEventGroupSetBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_MUTED);
+            muted = true;
+          }
+          // Discard anything written before the mute took effect
+          this_mww->microphone_->reset();
+          vTaskDelay(pdMS_TO_TICKS(DATA_TIMEOUT_MS));
           continue;
         }
-
-        size_t num_samples_processed;
-        struct FrontendOutput frontend_output = FrontendProcessSamples(&this_mww->frontend_state_, audio_buffer,
-                                                                       new_samples_to_read, &num_samples_processed);
-
-        for (size_t i = 0; i < frontend_output.size; ++i) {
-          // These scaling values are set to match the TFLite audio frontend int8 output.
-          // The feature pipeline outputs 16-bit signed integers in roughly a 0 to 670
-          // range. In training, these are then arbitrarily divided by 25.6 to get
-          // float values in the rough range of 0.0 to 26.0. This scaling is performed
-          // for historical reasons, to match up with the output of other feature
-          // generators.
-          // The process is then further complicated when we quantize the model. This
-          // means we have to scale the 0.0 to 26.0 real values to the -128 (INT8_MIN)
-          // to 127 (INT8_MAX) signed integer numbers.
-          // All this means that to get matching values from our integer feature
-          // output into the tensor input, we have to perform:
-          // input = (((feature / 25.6) / 26.0) * 256) - 128
-          // To simplify this and perform it in 32-bit integer math, we rearrange to:
-          // input = (feature * 256) / (25.6 * 26.0) - 128
-          constexpr int32_t value_scale = 256;
-          constexpr int32_t value_div = 666;  // 666 = 25.6 * 26.0 after rounding
-          int32_t value = ((frontend_output.values[i] * value_scale) + (value_div / 2)) / value_div;
-
-          value -= INT8_MIN;
-          features_buffer[i] = clamp<int8_t>(value, INT8_MIN, INT8_MAX);
+        if (muted) {
+          // Start from a clean state, as if wake word detection had just started
+          this_mww->reset_features_();
+          xEventGroupClearBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_MUTED);
+          ESP_LOGD(TAG, "Microphone unmuted; resuming wake word detection");
+          muted = false;
         }
 
-        if (!xQueueSendToBack(this_mww->features_queue_, features_buffer, 0)) {
-          // Features queue is too full, so we fell behind on inferring!
+        // Borrow the samples from the microphone's buffer rather than copying them. The window accepts any number of
+        // samples and keeps the remainder of a partial window, so spans shorter than a step (e.g., at the buffer's
+        // wrap point) are fine.
+        const microphone::SampleSpan span =
+            this_mww->microphone_->acquire(new_samples_to_read, pdMS_TO_TICKS(DATA_TIMEOUT_MS));
+        if (span.empty()) {
+          continue;
+        }
 
-          xEventGroupSetBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_WARNING_FEATURES_FULL);
+        size_t samples_processed = 0;
+        while (samples_processed < span.size) {
+          size_t samples_read = 0;
+          const bool window_ready =
+              WindowProcessSamples(&this_mww->frontend_state_.window, span.data + samples_processed,
+                                   span.size - samples_processed, &samples_read);
+          samples_processed += samples_read;
+
+          if (window_ready) {
+            ++stats_windows;
+            if (!this_mww->process_features_window_(stats_shared_us)) {
+              // Features queue is too full, so we fell behind on inferring!
+              xEventGroupSetBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_WARNING_FEATURES_FULL);
+            }
+          }
+        }
+        this_mww->microphone_->release(span);
+
+        const uint32_t stats_elapsed_ms = millis() - stats_last_report_ms;
+        if ((stats_elapsed_ms > STATS_REPORT_INTERVAL_MS) && (stats_windows > 0)) {
+          ESP_LOGV(TAG, "%" PRIu32 " windows at %u ms steps: FFT and filterbank %.1f us per window", stats_windows,
+                   this_mww->features_step_size_, (float) stats_shared_us / stats_windows);
+          for (auto &stream : this_mww->feature_streams_) {
+            // Per window figures add up with the shared cost to the total; a single step has exactly one stream
+            ESP_LOGV(TAG, "  %u ms stream for %u models: %.1f us per slice, %.1f us per window", stream.step_size,
+                     (unsigned) stream.models.size(),
+                     (stream.stats_slices > 0) ? (float) stream.stats_us / stream.stats_slices : 0.0f,
+                     (float) stream.stats_us / stats_windows);
+            stream.stats_us = 0;
+            stream.stats_slices = 0;
+          }
+          stats_windows = 0;
+          stats_shared_us = 0;
+          stats_last_report_ms = millis();
         }
       }
 
+      xEventGroupClearBits(this_mww->event_group_, EventGroupBits::PREPROCESSOR_MESSAGE_MUTED);
+
       this_mww->microphone_->stop();
 
+      this_mww->free_feature_streams_();
       FrontendFreeStateContents(&this_mww->frontend_state_);
+    }
+  }
+}
+
+// Position of the most significant set bit, counting from 1; matches the frontend library's helper
+static inline int most_significant_bit(uint32_t value) { return (value == 0) ? 0 : 32 - __builtin_clz(value); }
+
+bool MicroWakeWord::process_features_window_(uint32_t &shared_us) {
+  uint32_t start_us = micros();
+
+  // The shared part of ``FrontendProcessSamples``: FFT the window and accumulate the filterbank channels
+  const int input_shift = 15 - most_significant_bit(this->frontend_state_.window.max_abs_output_value);
+  FftCompute(&this->frontend_state_.fft, this->frontend_state_.window.output, input_shift);
+
+  // The FFT's output buffer is reused to hold the energy
+  int32_t *energy = (int32_t *) this->frontend_state_.fft.output;
+  FilterbankConvertFftComplexToEnergy(&this->frontend_state_.filterbank, this->frontend_state_.fft.output, energy);
+  FilterbankAccumulateChannels(&this->frontend_state_.filterbank, energy);
+  const uint32_t *scaled_filterbank = FilterbankSqrt(&this->frontend_state_.filterbank, input_shift);
+
+  const int correction_bits = most_significant_bit(this->frontend_state_.fft.fft_size) - 1 - (kFilterbankBits / 2);
+
+  shared_us += micros() - start_us;
+
+  bool queued = true;
+  int8_t features_buffer[PREPROCESSOR_FEATURE_SIZE];
+
+  // Coarser streams are sent first. Their slices are queued by the time the inference task receives the finest
+  // stream's slice for the same window.
+  for (auto &stream : this->feature_streams_) {
+    if (stream.phase > 0) {
+      stream.phase = (stream.phase + 1) % stream.decimation;
+      continue;
+    }
+    stream.phase = (stream.decimation > 1) ? 1 : 0;
+
+    const uint32_t stream_start_us = micros();
+    std::memcpy(stream.filterbank, scaled_filterbank, sizeof(stream.filterbank));
+    NoiseReductionApply(&stream.noise_reduction, stream.filterbank);
+    if (stream.pcan_gain_control.enable_pcan) {
+      PcanGainControlApply(&stream.pcan_gain_control, stream.filterbank);
+    }
+    const uint16_t *logged_filterbank =
+        LogScaleApply(&stream.log_scale, stream.filterbank, PREPROCESSOR_FEATURE_SIZE, correction_bits);
+
+    for (size_t i = 0; i < PREPROCESSOR_FEATURE_SIZE; ++i) {
+      // These scaling values are set to match the TFLite audio frontend int8 output.
+      // The feature pipeline outputs 16-bit signed integers in roughly a 0 to 670
+      // range. In training, these are then arbitrarily divided by 25.6 to get
+      // float values in the rough range of 0.0 to 26.0. This scaling is performed
+      // for historical reasons, to match up with the output of other feature
+      // generators.
+      // The process is then further complicated when we quantize the model. This
+      // means we have to scale the 0.0 to 26.0 real values to the -128 (INT8_MIN)
+      // to 127 (INT8_MAX) signed integer numbers.
+      // All this means that to get matching values from our integer feature
+      // output into the tensor input, we have to perform:
+      // input = (((feature / 25.6) / 26.0) * 256) - 128
+      // To simplify this and perform it in 32-bit integer math, we rearrange to:
+      // input = (feature * 256) / (25.6 * 26.0) - 128
+      constexpr int32_t value_scale = 256;
+      constexpr int32_t value_div = 666;  // 666 = 25.6 * 26.0 after rounding
+      int32_t value = ((logged_filterbank[i] * value_scale) + (value_div / 2)) / value_div;
+
+      value -= INT8_MIN;
+      features_buffer[i] = clamp<int8_t>(value, INT8_MIN, INT8_MAX);
+    }
+
+    if (!xQueueSendToBack(stream.queue, features_buffer, 0)) {
+      queued = false;
+    }
+
+    stream.stats_us += micros() - stream_start_us;
+    ++stream.stats_slices;
+  }
+
+  return queued;
+}
+
+bool MicroWakeWord::setup_feature_streams_() {
+  std::vector<StreamingModel *> models(this->wake_word_models_.begin(), this->wake_word_models_.end());
+#ifdef USE_MICRO_WAKE_WORD_VAD
+  models.push_back(this->vad_model_.get());
+#endif
+
+  if (models.empty()) {
+    return false;
+  }
 
-      if (audio_buffer != nullptr) {
-        int16_allocator.deallocate(audio_buffer, new_samples_to_read);
+  this->features_step_size_ = UINT8_MAX;
+  for (auto *model : models) {
+    this->features_step_size_ = std::min(this->features_step_size_, model->get_features_step_size());
+  }
+
+  for (auto *model : models) {
+    const uint8_t step_size = model->get_features_step_size();
+    auto stream = std::find_if(this->feature_streams_.begin(), this->feature_streams_.end(),
+                               [step_size](const FeatureStream &stream) { return stream.step_size == step_size; });
+    if (stream == this->feature_streams_.end()) {
+      FeatureStream new_stream{};
+      new_stream.step_size = step_size;
+      new_stream.decimation = step_size / this->features_step_size_;
+      new_stream.queue = xQueueCreate(FEATURES_QUEUE_LENGTH, PREPROCESSOR_FEATURE_SIZE * sizeof(int8_t));
+      if (new_stream.queue == nullptr) {
+        return false;
       }
+      this->feature_streams_.push_back(new_stream);
+      stream = this->feature_streams_.end() - 1;
+    }
+    stream->models.push_back(model);
+  }
+
+  std::sort(this->feature_streams_.begin(), this->feature_streams_.end(),
+            [](const FeatureStream &a, const FeatureStream &b) { return a.step_size > b.step_size; });
+
+  return true;
+}
+
+bool MicroWakeWord::populate_feature_streams_() {
+  const int input_correction_bits =
+      most_significant_bit(this->frontend_state_.fft.fft_size) - 1 - (kFilterbankBits / 2);
+
+  bool success = true;
+  for (auto &stream : this->feature_streams_) {
+    stream.phase = 0;
+    if (!NoiseReductionPopulateState(&this->frontend_config_.noise_reduction, &stream.noise_reduction,
+                                     PREPROCESSOR_FEATURE_SIZE) ||
+        !PcanGainControlPopulateState(&this->frontend_config_.pcan_gain_control, &stream.pcan_gain_control,
+                                      stream.noise_reduction.estimate, PREPROCESSOR_FEATURE_SIZE,
+                                      stream.noise_reduction.smoothing_bits, input_correction_bits) ||
+        !LogScalePopulateState(&this->frontend_config_.log_scale, &stream.log_scale)) {
+      success = false;
     }
   }
+  return success;
+}
+
+void MicroWakeWord::reset_features_() {
+  FrontendReset(&this->frontend_state_);
+  for (auto &stream : this->feature_streams_) {
+    stream.phase = 0;
+    NoiseReductionReset(&stream.noise_reduction);
+    xQueueReset(stream.queue);
+  }
+}
+
+void MicroWakeWord::free_feature_streams_() {
+  for (auto &stream : this->feature_streams_) {
+    NoiseReductionFreeStateContents(&stream.noise_reduction);
+    PcanGainControlFreeStateContents(&stream.pcan_gain_control);
+    // Cleared so freeing again after a failed populate is safe
+    stream.noise_reduction.estimate = nullptr;
+    stream.pcan_gain_control.gain_lut = nullptr;
+  }
 }
 
 std::vector<WakeWordModel *> MicroWakeWord::get_wake_words() {
@@ -239,9 +435,29 @@ void MicroWakeWord::inference_task_(void *params) {
     xEventGroupClearBits(this_mww->event_group_, EventGroupBits::INFERENCE_MESSAGE_IDLE);
 
     {
+      this_mww->detected_since_start_ = false;
       xEventGroupSetBits(this_mww->event_group_, EventGroupBits::INFERENCE_MESSAGE_STARTED);
 
+      bool muted = false;
+
       while (!(xEventGroupGetBits(this_mww->event_group_) & COMMAND_STOP)) {
+        if (xEventGroupGetBits(this_mww->event_group_) & PREPROCESSOR_MESSAGE_MUTED) {
+          if (!muted) {
+            // Recent probabilities came from audio before the mute; don't let them combine with audio after it
+            for (auto &model : this_mww->wake_word_models_) {
+              model->reset_probabilities();
+            }
+#ifdef USE_MICRO_WAKE_WORD_VAD
+            this_mww->vad_model_->reset_probabilities();
+            this_mww->vad_state_ = false;
+#endif
+            muted = true;
+          }
+          vTaskDelay(pdMS_TO_TICKS(DATA_TIMEOUT_MS));
+          continue;
+        }
+        muted = false;
+
         if (!this_mww->update_model_probabilities_()) {
           // Ran into an issue with inference
           xEventGroupSetBits(this_mww->event_group_,
@@ -251,28 +467,56 @@ void MicroWakeWord::inference_task_(void *params) {
 #ifdef USE_MICRO_WAKE_WORD_VAD
         DetectionEvent vad_state = this_mww->vad_model_->determine_detected();
 
-        this_mww->vad_state_ = vad_state.detected;  // atomic write, so thread safe
+        // Atomic writes, so thread safe
+        const uint32_t now = millis();
+        if (vad_state.detected != this_mww->vad_state_) {
+          this_mww->vad_state_changed_ms_ = now;
+        }
+        this_mww->vad_state_ = vad_state.detected;
+        this_mww->vad_state_updated_ms_ = now;
 #endif
 
+        const bool in_cooldown = (this_mww->cooldown_period_ms_ > 0) && this_mww->detected_since_start_ &&
+                                 (millis() - this_mww->last_detection_ms_ < this_mww->cooldown_period_ms_);
+
+        // If several wake words are detected from the same audio, only the highest scoring one is reported
+        StreamingModel *best_model = nullptr;
+        DetectionEvent best_state;
+
         for (auto &model : this_mww->wake_word_models_) {
           if (model->get_unprocessed_probability_status()) {
             // Only detect wake words if there is a new probability since the last check
             DetectionEvent wake_word_state = model->determine_detected();
             if (wake_word_state.detected) {
 #ifdef USE_MICRO_WAKE_WORD_VAD
-              if (vad_state.detected) {
-#endif
-                xQueueSend(this_mww->detection_queue_, &wake_word_state, portMAX_DELAY);
-                model->reset_probabilities();
-#ifdef USE_MICRO_WAKE_WORD_VAD
-              } else {
+              if (!vad_state.detected) {
                 wake_word_state.blocked_by_vad = true;
                 xQueueSend(this_mww->detection_queue_, &wake_word_state, portMAX_DELAY);
+                continue;
               }
 #endif
+              if (in_cooldown) {
+                // Another wake word was just reported; treat this detection as part of the same utterance
+                model->start_refractory_period();
+              } else if ((best_model == nullptr) || scores_higher(wake_word_state, best_state)) {
+                if (best_model != nullptr) {
+                  best_model->start_refractory_period();
+                }
+                best_model = model;
+                best_state = wake_word_state;
+              } else {
+                model->start_refractory_period();
+              }
             }
           }
         }
+
+        if (best_model != nullptr) {
+          xQueueSend(this_mww->detection_queue_, &best_state, portMAX_DELAY);
+          best_model->start_refractory_period();
+          this_mww->last_detection_ms_ = millis();
+          this_mww->detected_since_start_ = true;
+        }
       }
 
       this_mww->unload_models_();
@@ -284,8 +528,9 @@ void MicroWakeWord::add_wake_word_model(WakeWordModel *model) { this->wake_word_
 
 #ifdef USE_MICRO_WAKE_WORD_VAD
 void MicroWakeWord::add_vad_model(const uint8_t *model_start, uint8_t probability_cutoff, size_t sliding_window_size,
-                                  size_t tensor_arena_size) {
+                                  size_t tensor_arena_size, uint8_t features_step_size) {
   this->vad_model_ = make_unique<VADModel>(model_start, probability_cutoff, sliding_window_size, tensor_arena_size);
+  this->vad_model_->set_features_step_size(features_step_size);
 }
 #endif
 
@@ -408,7 +653,9 @@ void MicroWakeWord::stop() {
                       pdMS_TO_TICKS(STOPPING_TIMEOUT_MS));                   // Block to wait until the tasks stop
 
   xEventGroupClearBits(this->event_group_, ALL_BITS);
-  xQueueReset(this->features_queue_);
+  for (auto &stream : this->feature_streams_) {
+    xQueueReset(stream.queue);
+  }
   xQueueReset(this->detection_queue_);
 }
 
@@ -430,17 +677,28 @@ void MicroWakeWord::unload_models_() {
 }
 
 bool MicroWakeWord::update_model_probabilities_() {
-  int8_t audio_features[PREPROCESSOR_FEATURE_SIZE];
+  int8_t finest_features[PREPROCESSOR_FEATURE_SIZE];
+  int8_t stream_features[PREPROCESSOR_FEATURE_SIZE];
+
+  FeatureStream &finest_stream = this->feature_streams_.back();
 
   bool success = true;
-  if (xQueueReceive(this->features_queue_, &audio_features, pdMS_TO_TICKS(DATA_TIMEOUT_MS))) {
-    for (auto &model : this->wake_word_models_) {
-      // Perform inference
-      success = success & model->perform_streaming_inference(audio_features);
+  if (xQueueReceive(finest_stream.queue, &finest_features, pdMS_TO_TICKS(DATA_TIMEOUT_MS))) {
+    for (auto &stream : this->feature_streams_) {
+      const int8_t *audio_features = finest_features;
+      if (&stream != &finest_stream) {
+        if (!xQueueReceive(stream.queue, &stream_features, 0)) {
+          // This stream's step hasn't elapsed yet
+          continue;
+        }
+        audio_features = stream_features;
+      }
+
+      for (auto *model : stream.models) {
+        // Perform inference
+        success = success & model->perform_streaming_inference(audio_features);
+      }
     }
-#ifdef USE_MICRO_WAKE_WORD_VAD
-    success = success & this->vad_model_->perform_streaming_inference(audio_features);
-#endif
   }
 
   return success;
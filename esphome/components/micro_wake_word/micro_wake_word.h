@@ -10,6 +10,7 @@
 
 #include "esphome/components/microphone/microphone.h"
 
+#include <frontend.h>
 #include <frontend_util.h>
 
 #include <tensorflow/lite/core/c/common.h>
@@ -25,6 +26,29 @@ enum State {
   DETECTING_WAKE_WORD,
 };
 
+// Spectrogram features at a single step size, shared by every model trained with that step
+//  - The preprocessor windows the audio and computes the FFT and filterbank once, at the finest step any model uses.
+//    A stream with a coarser step takes every ``decimation``-th of those filterbank outputs.
+//  - Noise reduction, gain control, and log scaling smooth over consecutive slices, so each stream keeps its own
+//    state for them; its features then match what a preprocessor running at the stream's step would produce
+struct FeatureStream {
+  uint8_t step_size;   // In milliseconds
+  uint8_t decimation;  // Number of finest steps per slice
+  uint8_t phase{0};    // Finest steps since the stream's last slice
+
+  std::vector<StreamingModel *> models;
+  QueueHandle_t queue{nullptr};
+
+  struct NoiseReductionState noise_reduction;
+  struct PcanGainControlState pcan_gain_control;
+  struct LogScaleState log_scale;
+  uint32_t filterbank[PREPROCESSOR_FEATURE_SIZE];
+
+  // Time spent on this stream's stages and the slices it produced since the last stats report
+  uint32_t stats_us{0};
+  uint32_t stats_slices{0};
+};
+
 class MicroWakeWord : public Component {
  public:
   void setup() override;
@@ -37,7 +61,8 @@ class MicroWakeWord : public Component {
 
   bool is_running() const { return this->state_ != State::IDLE; }
 
-  void set_features_step_size(uint8_t step_size) { this->features_step_size_ = step_size; }
+  /// @brief Sets how long after a wake word is reported that detections from every model are ignored
+  void set_cooldown_period(uint32_t cooldown_period_ms) { this->cooldown_period_ms_ = cooldown_period_ms; }
 
   void set_microphone(microphone::Microphone *microphone) { this->microphone_ = microphone; }
 
@@ -47,10 +72,17 @@ class MicroWakeWord : public Component {
 
 #ifdef USE_MICRO_WAKE_WORD_VAD
   void add_vad_model(const uint8_t *model_start, uint8_t probability_cutoff, size_t sliding_window_size,
-                     size_t tensor_arena_size);
+                     size_t tensor_arena_size, uint8_t features_step_size);
 
   // Intended for the voice assistant component to fetch VAD status
   bool get_vad_state() { return this->vad_state_; }
+
+  /// @brief Returns the time (in ms) the VAD state last changed between speech and no speech
+  uint32_t get_vad_state_changed_ms() { return this->vad_state_changed_ms_; }
+
+  /// @brief Returns the time (in ms) the VAD state was last updated. It isn't updated while wake word detection is
+  /// stopped, so an old time means the state is stale.
+  uint32_t get_vad_state_updated_ms() { return this->vad_state_updated_ms_; }
 #endif
 
   // Intended for the voice assistant component to know which wake words are available
@@ -67,14 +99,25 @@ class MicroWakeWord : public Component {
 #ifdef USE_MICRO_WAKE_WORD_VAD
   std::unique_ptr<VADModel> vad_model_;
   bool vad_state_{false};
+  uint32_t vad_state_changed_ms_{0};
+  uint32_t vad_state_updated_ms_{0};
 #endif
 
   // Audio frontend handles generating spectrogram features
   struct FrontendConfig frontend_config_;
   struct FrontendState frontend_state_;
 
+  // Finest step size of all the models; the preprocessor computes the spectrum at this step
   uint8_t features_step_size_;
 
+  // Sorted by decreasing step size, so the last stream has the finest step
+  std::vector<FeatureStream> feature_streams_;
+
+  uint32_t cooldown_period_ms_{0};
+  // Only accessed by the inference task
+  uint32_t last_detection_ms_{0};
+  bool detected_since_start_{false};
+
   /// @brief Suspends the preprocessor and inference tasks
   void suspend_tasks_();
   /// @brief Resumes the preprocessor and inference tasks
@@ -88,11 +131,30 @@ class MicroWakeWord : public Component {
 
   /** Performs inference with each configured model
    *
-   * If enough audio samples are available, it will generate one slice of new features.
-   * It then loops through and performs inference with each of the loaded models.
+   * Waits for a slice of features from the finest step stream. Streams with coarser steps only have a slice
+   * available on some of those steps. It then performs inference with each model whose stream has a new slice.
    */
   bool update_model_probabilities_();
 
+  /// @brief Groups the models into feature streams by step size and creates each stream's features queue
+  bool setup_feature_streams_();
+
+  /// @brief Allocates each feature stream's noise reduction, gain control, and log scale state
+  bool populate_feature_streams_();
+
+  /// @brief Resets the frontend and each feature stream's state and discards any queued features. Only called by the
+  /// preprocessor task.
+  void reset_features_();
+
+  /// @brief Frees each feature stream's noise reduction and gain control state
+  void free_feature_streams_();
+
+  /// @brief Computes the spectrum of the frontend's current window and sends a slice to each stream due for one
+  /// @param shared_us Incremented by the time spent on the FFT and filterbank
+  /// @param streams_us Incremented by the time spent on the per stream stages
+  /// @return False if any stream's features queue is full
+  bool process_features_window_(uint32_t &shared_us);
+
   inline uint16_t new_samples_to_get_() { return (this->features_step_size_ * (AUDIO_SAMPLE_FREQUENCY / 1000)); }
 
   // Handles managing the start/stop/state of the preprocessor and inference tasks
@@ -101,9 +163,6 @@ class MicroWakeWord : public Component {
   // Used to send messages about the model's states to the main loop
   QueueHandle_t detection_queue_;
 
-  // Stores spectrogram features for inference
-  QueueHandle_t features_queue_;
-
   static void preprocessor_task_(void *params);
   TaskHandle_t preprocessor_task_handle_{nullptr};
   StaticTask_t preprocessor_task_stack_;
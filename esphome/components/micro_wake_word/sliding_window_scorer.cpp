@@ -0,0 +1,63 @@
+#ifdef USE_ESP_IDF
+
+#include "sliding_window_scorer.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace micro_wake_word {
+
+void SlidingWindowScorer::init(size_t window_size) {
+  this->window_size_ = std::max<size_t>(window_size, 1);
+  this->probabilities_.resize(this->window_size_);
+  this->candidates_.resize(this->window_size_);
+  this->reset();
+}
+
+void SlidingWindowScorer::reset() {
+  std::fill(this->probabilities_.begin(), this->probabilities_.end(), 0);
+  this->sum_ = 0;
+  this->count_ = 0;
+  this->candidates_head_ = 0;
+  this->candidates_length_ = 0;
+}
+
+void SlidingWindowScorer::add(uint8_t probability) {
+  const size_t position = this->count_ % this->window_size_;
+  this->sum_ = this->sum_ - this->probabilities_[position] + probability;
+  this->probabilities_[position] = probability;
+
+  // Drop the candidate that just left the window
+  if ((this->candidates_length_ > 0) &&
+      (this->count_ - this->candidates_[this->candidates_head_].index >= this->window_size_)) {
+    this->candidates_head_ = (this->candidates_head_ + 1) % this->window_size_;
+    --this->candidates_length_;
+  }
+
+  // Older candidates that aren't greater than the new probability can never be the maximum again
+  while (this->candidates_length_ > 0) {
+    const size_t tail = (this->candidates_head_ + this->candidates_length_ - 1) % this->window_size_;
+    if (this->candidates_[tail].probability > probability) {
+      break;
+    }
+    --this->candidates_length_;
+  }
+
+  const size_t tail = (this->candidates_head_ + this->candidates_length_) % this->window_size_;
+  this->candidates_[tail] = {this->count_, probability};
+  ++this->candidates_length_;
+
+  ++this->count_;
+}
+
+uint8_t SlidingWindowScorer::get_max() const {
+  if (this->candidates_length_ == 0) {
+    return 0;
+  }
+  return this->candidates_[this->candidates_head_].probability;
+}
+
+}  // namespace micro_wake_word
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace micro_wake_word {
+
+// Tracks the sum and maximum of the most recent probabilities from a streaming model
+//  - Adding a probability is O(1): the running sum drops the evicted value and adds the new one
+//  - The maximum comes from a monotonic queue of the window's probabilities in decreasing order. Each probability is
+//    added and removed at most once, so the amortized cost is O(1) regardless of the window size.
+//  - Before the window fills, the missing probabilities count as 0
+
+class SlidingWindowScorer {
+ public:
+  /// @brief Allocates the window and clears it
+  /// @param window_size Number of probabilities in the sliding window
+  void init(size_t window_size);
+
+  /// @brief Sets every probability in the window to 0
+  void reset();
+
+  /// @brief Adds the newest probability, evicting the oldest once the window is full
+  void add(uint8_t probability);
+
+  uint32_t get_sum() const { return this->sum_; }
+  uint8_t get_max() const;
+  uint8_t get_average() const { return this->sum_ / this->window_size_; }
+  size_t get_window_size() const { return this->window_size_; }
+
+  /// @brief Returns true if the window's average probability is greater than the cutoff
+  bool exceeds(uint8_t cutoff) const { return this->sum_ > static_cast<uint32_t>(cutoff) * this->window_size_; }
+
+ protected:
+  size_t window_size_{1};
+  uint32_t sum_{0};
+  uint32_t count_{0};  // Total probabilities added since the last reset; identifies each queue entry's age
+
+  std::vector<uint8_t> probabilities_;  // Circular buffer indexed by count_ modulo the window size
+
+  // Circular buffer of candidates for the maximum: values decrease from head to tail
+  struct Candidate {
+    uint32_t index;
+    uint8_t probability;
+  };
+  std::vector<Candidate> candidates_;
+  size_t candidates_head_{0};
+  size_t candidates_length_{0};
+};
+
+}  // namespace micro_wake_word
+}  // namespace esphome
+
+#endif
@@ -15,15 +15,24 @@ void WakeWordModel::log_model_config() {
   ESP_LOGCONFIG(TAG, "    - Wake Word: %s", this->wake_word_.c_str());
   ESP_LOGCONFIG(TAG, "      Probability cutoff: %.2f", this->probability_cutoff_ / 255.0f);
   ESP_LOGCONFIG(TAG, "      Sliding window size: %d", this->sliding_window_size_);
+  ESP_LOGCONFIG(TAG, "      Refractory period: %u slices", this->refractory_slices_);
+  ESP_LOGCONFIG(TAG, "      Feature step size: %u ms", this->features_step_size_);
 }
 
 void VADModel::log_model_config() {
   ESP_LOGCONFIG(TAG, "    - VAD Model");
   ESP_LOGCONFIG(TAG, "      Probability cutoff: %.2f", this->probability_cutoff_ / 255.0f);
   ESP_LOGCONFIG(TAG, "      Sliding window size: %d", this->sliding_window_size_);
+  ESP_LOGCONFIG(TAG, "      Feature step size: %u ms", this->features_step_size_);
 }
 
 bool StreamingModel::load_model_() {
+  if (this->model_start_ == nullptr) {
+    // The model is stored in the asset partition, but it wasn't found there
+    ESP_LOGE(TAG, "Streaming model data is missing");
+    return false;
+  }
+
   ExternalRAMAllocator<uint8_t> arena_allocator(ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE);
 
   if (this->tensor_arena_ == nullptr) {
@@ -142,10 +151,7 @@ bool StreamingModel::perform_streaming_inference(const int8_t features[PREPROCES
 
       TfLiteTensor *output = this->interpreter_->output(0);
 
-      ++this->last_n_index_;
-      if (this->last_n_index_ == this->sliding_window_size_)
-        this->last_n_index_ = 0;
-      this->recent_streaming_probabilities_[this->last_n_index_] = output->data.uint8[0];  // probability;
+      this->recent_streaming_probabilities_.add(output->data.uint8[0]);  // probability
       this->unprocessed_probability_status_ = true;
     }
     this->ignore_windows_ = std::min(this->ignore_windows_ + 1, 0);
@@ -154,12 +160,15 @@ bool StreamingModel::perform_streaming_inference(const int8_t features[PREPROCES
 }
 
 void StreamingModel::reset_probabilities() {
-  for (auto &prob : this->recent_streaming_probabilities_) {
-    prob = 0;
-  }
+  this->recent_streaming_probabilities_.reset();
   this->ignore_windows_ = -MIN_SLICES_BEFORE_DETECTION;
 }
 
+void StreamingModel::start_refractory_period() {
+  this->recent_streaming_probabilities_.reset();
+  this->ignore_windows_ = -static_cast<int32_t>(this->refractory_slices_);
+}
+
 WakeWordModel::WakeWordModel(const std::string &id, const uint8_t *model_start, uint8_t probability_cutoff,
                              size_t sliding_window_average_size, const std::string &wake_word, size_t tensor_arena_size,
                              bool default_enabled, bool internal_only) {
@@ -167,7 +176,7 @@ WakeWordModel::WakeWordModel(const std::string &id, const uint8_t *model_start,
   this->model_start_ = model_start;
   this->probability_cutoff_ = probability_cutoff;
   this->sliding_window_size_ = sliding_window_average_size;
-  this->recent_streaming_probabilities_.resize(sliding_window_average_size, 0);
+  this->recent_streaming_probabilities_.init(sliding_window_average_size);
   this->wake_word_ = wake_word;
   this->tensor_arena_size_ = tensor_arena_size;
   this->register_streaming_ops_(this->streaming_op_resolver_);
@@ -210,14 +219,9 @@ DetectionEvent WakeWordModel::determine_detected() {
     return detection_event;
   }
 
-  uint32_t sum = 0;
-  for (auto &prob : this->recent_streaming_probabilities_) {
-    detection_event.max_probability = std::max(detection_event.max_probability, prob);
-    sum += prob;
-  }
-
-  detection_event.average_probability = sum / this->sliding_window_size_;
-  detection_event.detected = sum > this->probability_cutoff_ * this->sliding_window_size_;
+  detection_event.max_probability = this->recent_streaming_probabilities_.get_max();
+  detection_event.average_probability = this->recent_streaming_probabilities_.get_average();
+  detection_event.detected = this->recent_streaming_probabilities_.exceeds(this->probability_cutoff_);
 
   this->unprocessed_probability_status_ = false;
   return detection_event;
@@ -228,7 +232,7 @@ VADModel::VADModel(const uint8_t *model_start, uint8_t probability_cutoff, size_
   this->model_start_ = model_start;
   this->probability_cutoff_ = probability_cutoff;
   this->sliding_window_size_ = sliding_window_size;
-  this->recent_streaming_probabilities_.resize(sliding_window_size, 0);
+  this->recent_streaming_probabilities_.init(sliding_window_size);
   this->tensor_arena_size_ = tensor_arena_size;
   this->register_streaming_ops_(this->streaming_op_resolver_);
 }
@@ -244,14 +248,9 @@ DetectionEvent VADModel::determine_detected() {
     return detection_event;
   }
 
-  uint32_t sum = 0;
-  for (auto &prob : this->recent_streaming_probabilities_) {
-    detection_event.max_probability = std::max(detection_event.max_probability, prob);
-    sum += prob;
-  }
-
-  detection_event.average_probability = sum / this->sliding_window_size_;
-  detection_event.detected = sum > (this->probability_cutoff_ * this->sliding_window_size_);
+  detection_event.max_probability = this->recent_streaming_probabilities_.get_max();
+  detection_event.average_probability = this->recent_streaming_probabilities_.get_average();
+  detection_event.detected = this->recent_streaming_probabilities_.exceeds(this->probability_cutoff_);
 
   return detection_event;
 }
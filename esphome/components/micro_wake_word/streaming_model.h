@@ -3,6 +3,7 @@
 #ifdef USE_ESP_IDF
 
 #include "preprocessor_settings.h"
+#include "sliding_window_scorer.h"
 
 #include "esphome/core/preferences.h"
 
@@ -42,6 +43,16 @@ class StreamingModel {
   /// @brief Sets all recent_streaming_probabilities to 0 and resets the ignore window count
   void reset_probabilities();
 
+  /// @brief Clears the probabilities after a detection and ignores the model for its refractory period
+  void start_refractory_period();
+
+  /// @brief Sets how many feature slices to ignore the model for after it detects something
+  void set_refractory_slices(uint16_t refractory_slices) { this->refractory_slices_ = refractory_slices; }
+
+  /// @brief Sets the step between feature slices (in ms) the model was trained with
+  void set_features_step_size(uint8_t step_size) { this->features_step_size_ = step_size; }
+  uint8_t get_features_step_size() const { return this->features_step_size_; }
+
   /// @brief Destroys the TFLite interpreter and frees the tensor and variable arenas' memory
   void unload_model();
 
@@ -69,13 +80,14 @@ class StreamingModel {
   bool enabled_{true};
   bool unprocessed_probability_status_{false};
   uint8_t current_stride_step_{0};
-  int16_t ignore_windows_{-MIN_SLICES_BEFORE_DETECTION};
+  uint8_t features_step_size_{10};
+  int32_t ignore_windows_{-MIN_SLICES_BEFORE_DETECTION};
+  uint16_t refractory_slices_{MIN_SLICES_BEFORE_DETECTION};
 
   uint8_t probability_cutoff_;  // Quantized probability cutoff mapping 0.0 - 1.0 to 0 - 255
   size_t sliding_window_size_;
-  size_t last_n_index_{0};
   size_t tensor_arena_size_;
-  std::vector<uint8_t> recent_streaming_probabilities_;
+  SlidingWindowScorer recent_streaming_probabilities_;
 
   const uint8_t *model_start_;
   uint8_t *tensor_arena_{nullptr};
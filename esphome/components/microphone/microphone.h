@@ -10,6 +10,18 @@
 namespace esphome {
 namespace microphone {
 
+// Read-only view of samples borrowed from a microphone's buffer
+//  - From a span callback, the span is only valid until the callback returns
+//  - From ``acquire``, the span is valid until it is passed to ``release``
+struct SampleSpan {
+  const int16_t *data{nullptr};
+  size_t size{0};  // Number of samples
+
+  const int16_t *begin() const { return this->data; }
+  const int16_t *end() const { return this->data + this->size; }
+  bool empty() const { return this->size == 0; }
+};
+
 enum State : uint8_t {
   STATE_STOPPED = 0,
   STATE_STARTING,
@@ -22,19 +34,53 @@ class Microphone {
  public:
   virtual void start() = 0;
   virtual void stop() = 0;
+
+  /// @brief Adds a callback that receives new samples as a span borrowed from the microphone, without copying them.
+  /// The span is only valid while the callback runs. Callbacks receive every sample independently of read() and
+  /// acquire(). Add them before setup, since implementations may only allocate a buffer for them then.
+  void add_span_callback(std::function<void(SampleSpan)> &&span_callback) {
+    this->span_callbacks_.add(std::move(span_callback));
+    this->has_span_callbacks_ = true;
+  }
+
+  /// @brief Adds a callback that receives new samples in a vector. The samples are copied into a vector owned by the
+  /// callback, which only allocates when it grows. Prefer add_span_callback, which doesn't copy.
   void add_data_callback(std::function<void(const std::vector<int16_t> &)> &&data_callback) {
-    this->data_callbacks_.add(std::move(data_callback));
+    this->add_span_callback(
+        [data_callback = std::move(data_callback), samples = std::vector<int16_t>()](SampleSpan span) mutable {
+          samples.assign(span.begin(), span.end());
+          data_callback(samples);
+        });
   }
+
   virtual size_t read(int16_t *buf, size_t len) = 0;
 
   /// @brief Reads from the microphone blocking ticks_to_wait FreeRTOS ticks. Intended for use in tasks.
   virtual size_t read(int16_t *buf, size_t len, TickType_t ticks_to_wait) { return this->read(buf, len); }
 
+  /// @brief Borrows up to max_samples from the microphone without copying them. Intended for use in tasks. Only one
+  /// span may be acquired at a time; pass it to release() before acquiring the next. The default implementation copies
+  /// into an internal buffer for microphones that can't lend their samples.
+  /// @return The samples; empty if none arrived within ticks_to_wait
+  virtual SampleSpan acquire(size_t max_samples, TickType_t ticks_to_wait) {
+    this->acquire_buffer_.resize(max_samples);
+    const size_t bytes_read =
+        this->read(this->acquire_buffer_.data(), max_samples * sizeof(int16_t), ticks_to_wait);
+    return SampleSpan{this->acquire_buffer_.data(), bytes_read / sizeof(int16_t)};
+  }
+
+  /// @brief Returns a span from acquire() to the microphone
+  virtual void release(SampleSpan span) {}
+
   /// @brief If the microphone implementation uses a ring buffer, this will reset it - discarding all the stored data
   virtual void reset() {}
 
   virtual void set_mute_state(bool mute_state) {};
 
+  /// @brief Returns true if the microphone is muted. A muted microphone may stop writing samples entirely, so
+  /// consumers should pause their processing instead of waiting for audio. Safe to call from any task.
+  virtual bool get_mute_state() { return false; }
+
   bool is_running() const { return this->state_ == STATE_RUNNING; }
   bool is_stopped() const { return this->state_ == STATE_STOPPED; }
   bool is_muted() const { return this->state_ == STATE_MUTED; }
@@ -42,7 +88,11 @@ class Microphone {
  protected:
   State state_{STATE_STOPPED};
 
-  CallbackManager<void(const std::vector<int16_t> &)> data_callbacks_{};
+  // Implementations call these with their new samples from the main loop
+  CallbackManager<void(SampleSpan)> span_callbacks_{};
+  bool has_span_callbacks_{false};
+
+  std::vector<int16_t> acquire_buffer_;
 };
 
 }  // namespace microphone
@@ -2,8 +2,6 @@
 
 #include "audio_decoder.h"
 
-#include "mp3_decoder.h"
-
 #include "esphome/core/ring_buffer.h"
 
 namespace esphome {
@@ -11,6 +9,64 @@ namespace nabu {
 
 static const size_t READ_WRITE_TIMEOUT_MS = 20;
 
+static const uint32_t FLAC_WORKER_TASK_STACK_SIZE = 3 * 1024;
+
+esp_err_t FLACFrameWorker::start(const std::string &task_name, UBaseType_t priority) {
+  if (this->task_stack_buffer_ == nullptr)
+    this->task_stack_buffer_ = (StackType_t *) malloc(FLAC_WORKER_TASK_STACK_SIZE);
+
+  if (this->task_stack_buffer_ == nullptr) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (this->task_handle_ == nullptr) {
+    // Not pinned, so the scheduler runs it on whichever core isn't busy with the caller's frame
+    this->task_handle_ = xTaskCreateStatic(FLACFrameWorker::worker_task_, task_name.c_str(),
+                                           FLAC_WORKER_TASK_STACK_SIZE, (void *) this, priority,
+                                           this->task_stack_buffer_, &this->task_stack_);
+  }
+
+  if (this->task_handle_ == nullptr) {
+    return ESP_FAIL;
+  }
+
+  return ESP_OK;
+}
+
+void FLACFrameWorker::dispatch(FLACStreamDecoder *decoder, const uint8_t *buffer, size_t buffer_length,
+                               int16_t *output_buffer) {
+  this->caller_task_handle_ = xTaskGetCurrentTaskHandle();
+  this->decoder_ = decoder;
+  this->buffer_ = buffer;
+  this->buffer_length_ = buffer_length;
+  this->output_buffer_ = output_buffer;
+
+  xTaskNotifyGive(this->task_handle_);
+}
+
+FLACDecoderResult FLACFrameWorker::wait(size_t &samples_decoded, size_t &bytes_consumed) {
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  samples_decoded = this->samples_decoded_;
+  bytes_consumed = this->bytes_consumed_;
+  return this->result_;
+}
+
+void FLACFrameWorker::worker_task_(void *params) {
+  FLACFrameWorker *this_worker = (FLACFrameWorker *) params;
+
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    this_worker->result_ =
+        this_worker->decoder_->decode_frame(this_worker->buffer_, this_worker->buffer_length_,
+                                            this_worker->output_buffer_, this_worker->samples_decoded_,
+                                            this_worker->bytes_consumed_);
+
+    xTaskNotifyGive(this_worker->caller_task_handle_);
+  }
+}
+
 AudioDecoder::AudioDecoder(RingBuffer *input_ring_buffer, RingBuffer *output_ring_buffer, size_t internal_buffer_size) {
   this->input_ring_buffer_ = input_ring_buffer;
   this->output_ring_buffer_ = output_ring_buffer;
@@ -27,13 +83,23 @@ AudioDecoder::~AudioDecoder() {
   }
 
   if (this->flac_decoder_ != nullptr) {
-    this->flac_decoder_->free_buffers();
     this->flac_decoder_.reset();  // Free the unique_ptr
     this->flac_decoder_ = nullptr;
   }
 
-  if (this->media_file_type_ == media_player::MediaFileType::MP3) {
-    MP3FreeDecoder(this->mp3_decoder_);
+  if (this->flac_worker_decoder_ != nullptr) {
+    this->flac_worker_decoder_.reset();  // Free the unique_ptr
+    this->flac_worker_decoder_ = nullptr;
+  }
+
+  if (this->mp3_decoder_ != nullptr) {
+    this->mp3_decoder_.reset();  // Free the unique_ptr
+    this->mp3_decoder_ = nullptr;
+  }
+
+  if (this->qoa_decoder_ != nullptr) {
+    this->qoa_decoder_.reset();  // Free the unique_ptr
+    this->qoa_decoder_ = nullptr;
   }
 
   if (this->wav_decoder_ != nullptr) {
@@ -61,10 +127,16 @@ esp_err_t AudioDecoder::start(media_player::MediaFileType media_file_type) {
 
   switch (this->media_file_type_) {
     case media_player::MediaFileType::FLAC:
-      this->flac_decoder_ = make_unique<flac::FLACDecoder>(this->input_buffer_);
+      this->flac_decoder_ = make_unique<FLACStreamDecoder>();
       break;
     case media_player::MediaFileType::MP3:
-      this->mp3_decoder_ = MP3InitDecoder();
+      this->mp3_decoder_ = MP3Backend::create();
+      if (this->mp3_decoder_ == nullptr) {
+        return ESP_ERR_NO_MEM;
+      }
+      break;
+    case media_player::MediaFileType::QOA:
+      this->qoa_decoder_ = make_unique<QOADecoder>();
       break;
     case media_player::MediaFileType::WAV:
       this->wav_decoder_ = make_unique<wav_decoder::WAVDecoder>(&this->input_buffer_current_);
@@ -153,6 +225,9 @@ AudioDecoderState AudioDecoder::decode(bool stop_gracefully) {
           case media_player::MediaFileType::MP3:
             state = this->decode_mp3_();
             break;
+          case media_player::MediaFileType::QOA:
+            state = this->decode_qoa_();
+            break;
           case media_player::MediaFileType::WAV:
             state = this->decode_wav_();
             break;
@@ -194,62 +269,151 @@ esp_err_t AudioDecoder::allocate_buffers_() {
 FileDecoderState AudioDecoder::decode_flac_() {
   if (!this->audio_stream_info_.has_value()) {
     // Header hasn't been read
-    auto result = this->flac_decoder_->read_header(this->input_buffer_length_);
+    size_t bytes_consumed = 0;
+    auto result =
+        this->flac_decoder_->read_header(this->input_buffer_current_, this->input_buffer_length_, bytes_consumed);
 
-    if (result == flac::FLAC_DECODER_HEADER_OUT_OF_DATA) {
+    // The header is parsed incrementally; skipped metadata (e.g., album art) is discarded as it is read
+    this->input_buffer_current_ += bytes_consumed;
+    this->input_buffer_length_ -= bytes_consumed;
+
+    if (result == FLACDecoderResult::HEADER_OUT_OF_DATA) {
+      if (bytes_consumed > 0) {
+        // Made progress; refill the buffer and continue
+        return FileDecoderState::MORE_TO_PROCESS;
+      }
       return FileDecoderState::POTENTIALLY_FAILED;
     }
 
-    if (result != flac::FLAC_DECODER_SUCCESS) {
+    if (result != FLACDecoderResult::SUCCESS) {
       // Couldn't read FLAC header
       return FileDecoderState::FAILED;
     }
 
-    size_t bytes_consumed = this->flac_decoder_->get_bytes_index();
-    this->input_buffer_current_ += bytes_consumed;
-    this->input_buffer_length_ = this->flac_decoder_->get_bytes_left();
-
     size_t flac_decoder_output_buffer_min_size = flac_decoder_->get_output_buffer_size();
     if (this->internal_buffer_size_ < flac_decoder_output_buffer_min_size * sizeof(int16_t)) {
       // Output buffer is not big enough
       return FileDecoderState::FAILED;
     }
 
+    if ((this->flac_frame_worker_ != nullptr) &&
+        (this->internal_buffer_size_ >= 2 * flac_decoder_output_buffer_min_size * sizeof(int16_t))) {
+      // Both frames of a pair fit in the output buffer, so decode pairs with a second decoder on the worker
+      this->flac_worker_decoder_ = make_unique<FLACStreamDecoder>();
+      if (this->flac_worker_decoder_->copy_header(*this->flac_decoder_) != FLACDecoderResult::SUCCESS) {
+        // Not enough memory for a second decoder; decode one frame at a time instead
+        this->flac_worker_decoder_.reset();
+        this->flac_worker_decoder_ = nullptr;
+      }
+    }
+
     audio::AudioStreamInfo audio_stream_info;
     audio_stream_info.channels = this->flac_decoder_->get_num_channels();
     audio_stream_info.sample_rate = this->flac_decoder_->get_sample_rate();
-    audio_stream_info.bits_per_sample = this->flac_decoder_->get_sample_depth();
+    // The decoder scales every sample depth to 16 bits
+    audio_stream_info.bits_per_sample = 16;
 
     this->audio_stream_info_ = audio_stream_info;
 
     return FileDecoderState::MORE_TO_PROCESS;
   }
 
-  uint32_t output_samples = 0;
-  auto result =
-      this->flac_decoder_->decode_frame(this->input_buffer_length_, (int16_t *) this->output_buffer_, &output_samples);
+  if (this->flac_worker_decoder_ != nullptr) {
+    size_t second_frame_offset = 0;
+    if (this->flac_decoder_->find_next_frame(this->input_buffer_current_, this->input_buffer_length_,
+                                             second_frame_offset)) {
+      return this->decode_flac_frame_pair_(second_frame_offset);
+    }
+    // The buffer doesn't start with a frame followed by the complete header of the next one. Decoding a single
+    // frame handles resyncing after corrupt data, the final frame, and waiting for more data.
+  }
+
+  return this->decode_flac_frame_();
+}
+
+FileDecoderState AudioDecoder::decode_flac_frame_() {
+  size_t output_samples = 0;
+  size_t bytes_consumed = 0;
+  auto result = this->flac_decoder_->decode_frame(this->input_buffer_current_, this->input_buffer_length_,
+                                                  (int16_t *) this->output_buffer_, output_samples, bytes_consumed);
+
+  // On errors, the decoder consumes any bytes before the next potential frame
+  this->input_buffer_current_ += bytes_consumed;
+  this->input_buffer_length_ -= bytes_consumed;
 
-  if (result == flac::FLAC_DECODER_ERROR_OUT_OF_DATA) {
+  if (result == FLACDecoderResult::ERROR_OUT_OF_DATA) {
     // Not an issue, just needs more data that we'll get next time.
     return FileDecoderState::POTENTIALLY_FAILED;
-  } else if (result > flac::FLAC_DECODER_ERROR_OUT_OF_DATA) {
+  } else if (result > FLACDecoderResult::ERROR_OUT_OF_DATA) {
     // Corrupted frame, don't retry with current buffer content, wait for new sync
-    size_t bytes_consumed = this->flac_decoder_->get_bytes_index();
-    this->input_buffer_current_ += bytes_consumed;
-    this->input_buffer_length_ = this->flac_decoder_->get_bytes_left();
-
     return FileDecoderState::POTENTIALLY_FAILED;
   }
 
   // We have successfully decoded some input data and have new output data
-  size_t bytes_consumed = this->flac_decoder_->get_bytes_index();
-  this->input_buffer_current_ += bytes_consumed;
-  this->input_buffer_length_ = this->flac_decoder_->get_bytes_left();
-
   this->output_buffer_current_ = this->output_buffer_;
   this->output_buffer_length_ = output_samples * sizeof(int16_t);
 
-  if (result == flac::FLAC_DECODER_NO_MORE_FRAMES) {
+  if (result == FLACDecoderResult::NO_MORE_FRAMES) {
+    return FileDecoderState::END_OF_FILE;
+  }
+
+  return FileDecoderState::IDLE;
+}
+
+FileDecoderState AudioDecoder::decode_flac_frame_pair_(size_t second_frame_offset) {
+  size_t frame_buffer_samples = this->flac_decoder_->get_output_buffer_size();
+  int16_t *output_buffer = (int16_t *) this->output_buffer_;
+
+  // The worker decodes the second frame into the second half of the output buffer
+  this->flac_frame_worker_->dispatch(this->flac_worker_decoder_.get(),
+                                     this->input_buffer_current_ + second_frame_offset,
+                                     this->input_buffer_length_ - second_frame_offset,
+                                     output_buffer + frame_buffer_samples);
+
+  size_t first_samples = 0;
+  size_t first_bytes_consumed = 0;
+  auto first_result = this->flac_decoder_->decode_frame(this->input_buffer_current_, second_frame_offset,
+                                                        output_buffer, first_samples, first_bytes_consumed);
+
+  size_t second_samples = 0;
+  size_t second_bytes_consumed = 0;
+  auto second_result = this->flac_frame_worker_->wait(second_samples, second_bytes_consumed);
+
+  if (first_result == FLACDecoderResult::ERROR_OUT_OF_DATA) {
+    // The first frame runs past the found boundary, so it was a false sync code. Decode the frame on its own.
+    return this->decode_flac_frame_();
+  } else if (first_result > FLACDecoderResult::ERROR_OUT_OF_DATA) {
+    // Corrupted frame, skip past its sync code and wait for a new sync
+    this->input_buffer_current_ += first_bytes_consumed;
+    this->input_buffer_length_ -= first_bytes_consumed;
+    return FileDecoderState::POTENTIALLY_FAILED;
+  }
+
+  this->output_buffer_current_ = this->output_buffer_;
+  this->output_buffer_length_ = first_samples * sizeof(int16_t);
+
+  if ((first_result == FLACDecoderResult::NO_MORE_FRAMES) ||
+      ((second_result != FLACDecoderResult::SUCCESS) && (second_result != FLACDecoderResult::NO_MORE_FRAMES))) {
+    // Only keep the first frame; an incomplete or corrupt second frame is handled when it is decoded on its own
+    this->input_buffer_current_ += first_bytes_consumed;
+    this->input_buffer_length_ -= first_bytes_consumed;
+
+    if (first_result == FLACDecoderResult::NO_MORE_FRAMES) {
+      return FileDecoderState::END_OF_FILE;
+    }
+    return FileDecoderState::IDLE;
+  }
+
+  if (first_samples < frame_buffer_samples) {
+    // Variable block size stream; close the gap so the frames are contiguous
+    memmove(output_buffer + first_samples, output_buffer + frame_buffer_samples, second_samples * sizeof(int16_t));
+  }
+  this->output_buffer_length_ += second_samples * sizeof(int16_t);
+
+  this->input_buffer_current_ += second_frame_offset + second_bytes_consumed;
+  this->input_buffer_length_ -= second_frame_offset + second_bytes_consumed;
+
+  if (second_result == FLACDecoderResult::NO_MORE_FRAMES) {
     return FileDecoderState::END_OF_FILE;
   }
 
@@ -257,46 +421,98 @@ FileDecoderState AudioDecoder::decode_flac_() {
 }
 
 FileDecoderState AudioDecoder::decode_mp3_() {
-  // Look for the next sync word
-  int32_t offset = MP3FindSyncWord(this->input_buffer_current_, this->input_buffer_length_);
-  if (offset < 0) {
-    // We may recover if we have more data
+  if (this->internal_buffer_size_ < MP3Backend::MAX_SAMPLES_PER_FRAME * sizeof(int16_t)) {
+    // Output buffer is not big enough
+    return FileDecoderState::FAILED;
+  }
+
+  MP3FrameResult frame_result;
+  auto result = this->mp3_decoder_->decode_frame(this->input_buffer_current_, this->input_buffer_length_,
+                                                 (int16_t *) this->output_buffer_, frame_result);
+
+  // The backend skips any bytes before the next sync word, even if it needs more data to decode the frame
+  this->input_buffer_current_ += frame_result.bytes_consumed;
+  this->input_buffer_length_ -= frame_result.bytes_consumed;
+
+  if (result == MP3DecoderResult::NEED_MORE_DATA) {
+    // Not a problem. Next call to decode will provide more data.
     return FileDecoderState::POTENTIALLY_FAILED;
+  } else if (result == MP3DecoderResult::FAILED) {
+    return FileDecoderState::FAILED;
   }
 
-  // Advance read pointer
-  this->input_buffer_current_ += offset;
-  this->input_buffer_length_ -= offset;
+  if (frame_result.samples_decoded > 0) {
+    this->output_buffer_length_ = frame_result.samples_decoded * sizeof(int16_t);
+    this->output_buffer_current_ = this->output_buffer_;
 
-  int err = MP3Decode(this->mp3_decoder_, &this->input_buffer_current_, (int *) &this->input_buffer_length_,
-                      (int16_t *) this->output_buffer_, 0);
-  if (err) {
-    switch (err) {
-      case ERR_MP3_MAINDATA_UNDERFLOW:
-        // Not a problem. Next call to decode will provide more data.
-        return FileDecoderState::POTENTIALLY_FAILED;
-        break;
-      default:
-        return FileDecoderState::FAILED;
-        break;
+    audio::AudioStreamInfo stream_info;
+    stream_info.channels = frame_result.channels;
+    stream_info.sample_rate = frame_result.sample_rate;
+    stream_info.bits_per_sample = 16;
+    this->audio_stream_info_ = stream_info;
+  }
+
+  return FileDecoderState::MORE_TO_PROCESS;
+}
+
+FileDecoderState AudioDecoder::decode_qoa_() {
+  if (!this->audio_stream_info_.has_value()) {
+    // Header hasn't been read
+    size_t bytes_consumed = 0;
+    auto result =
+        this->qoa_decoder_->read_header(this->input_buffer_current_, this->input_buffer_length_, bytes_consumed);
+
+    if (result == QOADecoderResult::HEADER_OUT_OF_DATA) {
+      return FileDecoderState::POTENTIALLY_FAILED;
     }
-  } else {
-    MP3FrameInfo mp3_frame_info;
-    MP3GetLastFrameInfo(this->mp3_decoder_, &mp3_frame_info);
-    if (mp3_frame_info.outputSamps > 0) {
-      int bytes_per_sample = (mp3_frame_info.bitsPerSample / 8);
-      this->output_buffer_length_ = mp3_frame_info.outputSamps * bytes_per_sample;
-      this->output_buffer_current_ = this->output_buffer_;
 
-      audio::AudioStreamInfo stream_info;
-      stream_info.channels = mp3_frame_info.nChans;
-      stream_info.sample_rate = mp3_frame_info.samprate;
-      stream_info.bits_per_sample = mp3_frame_info.bitsPerSample;
-      this->audio_stream_info_ = stream_info;
+    if (result != QOADecoderResult::SUCCESS) {
+      // Couldn't read QOA header
+      return FileDecoderState::FAILED;
+    }
+
+    this->input_buffer_current_ += bytes_consumed;
+    this->input_buffer_length_ -= bytes_consumed;
+
+    if (this->internal_buffer_size_ < this->qoa_decoder_->get_output_buffer_size() * sizeof(int16_t)) {
+      // Output buffer is not big enough
+      return FileDecoderState::FAILED;
     }
+
+    audio::AudioStreamInfo audio_stream_info;
+    audio_stream_info.channels = this->qoa_decoder_->get_num_channels();
+    audio_stream_info.sample_rate = this->qoa_decoder_->get_sample_rate();
+    audio_stream_info.bits_per_sample = 16;
+
+    this->audio_stream_info_ = audio_stream_info;
+
+    return FileDecoderState::MORE_TO_PROCESS;
   }
 
-  return FileDecoderState::MORE_TO_PROCESS;
+  size_t output_samples = 0;
+  size_t bytes_consumed = 0;
+  auto result = this->qoa_decoder_->decode_frame(this->input_buffer_current_, this->input_buffer_length_,
+                                                 (int16_t *) this->output_buffer_, output_samples, bytes_consumed);
+
+  if (result == QOADecoderResult::ERROR_OUT_OF_DATA) {
+    // Not an issue, just needs more data that we'll get next time.
+    return FileDecoderState::POTENTIALLY_FAILED;
+  } else if (result > QOADecoderResult::ERROR_OUT_OF_DATA) {
+    // QOA frames have no sync code to recover with
+    return FileDecoderState::FAILED;
+  }
+
+  this->input_buffer_current_ += bytes_consumed;
+  this->input_buffer_length_ -= bytes_consumed;
+
+  this->output_buffer_current_ = this->output_buffer_;
+  this->output_buffer_length_ = output_samples * sizeof(int16_t);
+
+  if (result == QOADecoderResult::NO_MORE_FRAMES) {
+    return FileDecoderState::END_OF_FILE;
+  }
+
+  return FileDecoderState::IDLE;
 }
 
 FileDecoderState AudioDecoder::decode_wav_() {
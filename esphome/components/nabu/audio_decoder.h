@@ -2,15 +2,20 @@
 
 #ifdef USE_ESP_IDF
 
-#include <flac_decoder.h>
 #include <wav_decoder.h>
-#include <mp3_decoder.h>
+
+#include "flac_stream_decoder.h"
+#include "mp3_backend.h"
+#include "qoa_decoder.h"
 
 #include "esphome/components/audio/audio.h"
 #include "esphome/components/media_player/media_player.h"
 
 #include "esphome/core/ring_buffer.h"
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
 namespace esphome {
 namespace nabu {
 
@@ -30,6 +35,44 @@ enum class FileDecoderState : uint8_t {
   END_OF_FILE,
 };
 
+// Decodes single FLAC frames on its own task, so the AudioDecoder can decode two frames at once on both cores
+class FLACFrameWorker {
+ public:
+  /// @brief Allocates the stack and creates the worker task if it doesn't exist yet. The task is never deleted.
+  /// @param task_name FreeRTOS task name
+  /// @param priority FreeRTOS task priority
+  /// @return ESP_OK if successful or an appropriate error if not
+  esp_err_t start(const std::string &task_name, UBaseType_t priority);
+
+  /// @brief Starts decoding a frame on the worker task. The decoder and buffers must stay valid until `wait` returns.
+  /// Must be called by the task that later calls `wait`.
+  void dispatch(FLACStreamDecoder *decoder, const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer);
+
+  /// @brief Blocks until the dispatched frame is decoded
+  /// @return The result of FLACStreamDecoder::decode_frame
+  FLACDecoderResult wait(size_t &samples_decoded, size_t &bytes_consumed);
+
+  TaskHandle_t get_task_handle() const { return this->task_handle_; }
+
+ protected:
+  static void worker_task_(void *params);
+  TaskHandle_t task_handle_{nullptr};
+  StaticTask_t task_stack_;
+  StackType_t *task_stack_buffer_{nullptr};
+
+  // Notified when the dispatched frame is decoded
+  TaskHandle_t caller_task_handle_{nullptr};
+
+  FLACStreamDecoder *decoder_{nullptr};
+  const uint8_t *buffer_{nullptr};
+  size_t buffer_length_{0};
+  int16_t *output_buffer_{nullptr};
+
+  FLACDecoderResult result_{FLACDecoderResult::SUCCESS};
+  size_t samples_decoded_{0};
+  size_t bytes_consumed_{0};
+};
+
 class AudioDecoder {
  public:
   AudioDecoder(esphome::RingBuffer *input_ring_buffer, esphome::RingBuffer *output_ring_buffer,
@@ -42,11 +85,20 @@ class AudioDecoder {
 
   const optional<audio::AudioStreamInfo> &get_audio_stream_info() const { return this->audio_stream_info_; }
 
+  /// @brief Decodes FLAC frames in pairs, with the worker decoding every second frame. Must be set before `start`.
+  /// Falls back to decoding one frame at a time if the frames don't fit twice in the output buffer.
+  void set_flac_frame_worker(FLACFrameWorker *flac_frame_worker) { this->flac_frame_worker_ = flac_frame_worker; }
+
  protected:
   esp_err_t allocate_buffers_();
 
   FileDecoderState decode_flac_();
+  FileDecoderState decode_flac_frame_();
+  /// @brief Decodes the frame at the start of the input buffer while the worker decodes the following frame
+  /// @param second_frame_offset Offset of the following frame's sync code
+  FileDecoderState decode_flac_frame_pair_(size_t second_frame_offset);
   FileDecoderState decode_mp3_();
+  FileDecoderState decode_qoa_();
   FileDecoderState decode_wav_();
 
   esphome::RingBuffer *input_ring_buffer_;
@@ -61,9 +113,13 @@ class AudioDecoder {
   uint8_t *output_buffer_current_{nullptr};
   size_t output_buffer_length_;
 
-  std::unique_ptr<flac::FLACDecoder> flac_decoder_;
+  std::unique_ptr<FLACStreamDecoder> flac_decoder_;
+  FLACFrameWorker *flac_frame_worker_{nullptr};
+  std::unique_ptr<FLACStreamDecoder> flac_worker_decoder_;  // Only allocated when decoding frame pairs
+
+  std::unique_ptr<MP3Backend> mp3_decoder_;
 
-  HMP3Decoder mp3_decoder_;
+  std::unique_ptr<QOADecoder> qoa_decoder_;
 
   std::unique_ptr<wav_decoder::WAVDecoder> wav_decoder_;
   size_t wav_bytes_left_;
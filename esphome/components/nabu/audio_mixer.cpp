@@ -6,20 +6,28 @@
 
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
 
 namespace esphome {
 namespace nabu {
 
 static const size_t INPUT_RING_BUFFER_SAMPLES = 24000;
-static const size_t OUTPUT_BUFFER_SAMPLES = 8192;
 static const size_t QUEUE_COUNT = 20;
 
 static const uint32_t TASK_STACK_SIZE = 3072;
-static const size_t TASK_DELAY_MS = 25;
+static const uint32_t TASK_DELAY_MS = 25;
+
+// How often the mixer logs its average per-block processing time
+static const uint32_t STATS_REPORT_INTERVAL_MS = 10000;
+
+static const char *const TAG = "nabu_media_player.mixer";
 
 static const int16_t MAX_AUDIO_SAMPLE_VALUE = INT16_MAX;
 static const int16_t MIN_AUDIO_SAMPLE_VALUE = INT16_MIN;
 
+// Samples with a magnitude at or below this level are treated as silence (allows for dithering noise)
+static const int16_t SILENCE_THRESHOLD = 8;
+
 esp_err_t AudioMixer::start(speaker::Speaker *speaker, const std::string &task_name, UBaseType_t priority) {
   esp_err_t err = this->allocate_buffers_();
 
@@ -67,15 +75,29 @@ void AudioMixer::audio_mixer_task_(void *params) {
   TaskEvent event;
   CommandEvent command_event;
 
+  const size_t block_samples = this_mixer->block_samples_;
+
+  // Never wait longer than a block's duration, so small blocks are refilled before the speaker runs dry
+  const uint32_t task_delay_ms = clamp<uint32_t>(this_mixer->block_duration_ms_, 1, TASK_DELAY_MS);
+
   ExternalRAMAllocator<int16_t> allocator(ExternalRAMAllocator<int16_t>::ALLOW_FAILURE);
-  int16_t *media_buffer = allocator.allocate(OUTPUT_BUFFER_SAMPLES);
-  int16_t *announcement_buffer = allocator.allocate(OUTPUT_BUFFER_SAMPLES);
-  int16_t *combination_buffer = allocator.allocate(OUTPUT_BUFFER_SAMPLES);
+  int16_t *media_buffer = allocator.allocate(block_samples);
+  int16_t *announcement_buffer = allocator.allocate(block_samples);
+  int16_t *combination_buffer = allocator.allocate(block_samples);
 
   int16_t *combination_buffer_current = combination_buffer;
   size_t combination_buffer_length = 0;
 
-  if ((media_buffer == nullptr) || (announcement_buffer == nullptr)) {
+  // Tracks the processing cost per block (reading, ducking, and mixing) to compare block sizes
+  uint32_t stats_blocks_mixed = 0;
+  uint32_t stats_processing_us = 0;
+  uint32_t stats_last_report_ms = millis();
+
+  // Number of zero-filled samples inserted because a stream couldn't fill its part of a mixed block
+  uint32_t stats_media_underrun_samples = 0;
+  uint32_t stats_announcement_underrun_samples = 0;
+
+  if ((media_buffer == nullptr) || (announcement_buffer == nullptr) || (combination_buffer == nullptr)) {
     event.type = EventType::WARNING;
     event.err = ESP_ERR_NO_MEM;
     xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
@@ -85,7 +107,7 @@ void AudioMixer::audio_mixer_task_(void *params) {
     xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
 
     while (true) {
-      delay(TASK_DELAY_MS);
+      delay(task_delay_ms);
     }
 
     return;
@@ -106,11 +128,29 @@ void AudioMixer::audio_mixer_task_(void *params) {
   size_t ducking_transition_samples_remaining = 0;
   size_t samples_per_ducking_step = 0;
 
+  // Handles the output standby state
+  const bool standby_enabled = (this_mixer->standby_timeout_ms_ > 0);
+  bool output_in_standby = false;
+  bool waiting_for_output_wake = false;
+  uint32_t wake_request_ms = 0;
+  uint32_t last_audible_ms = millis();
+
   event.type = EventType::STARTED;
   xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
 
   while (true) {
-    if (xQueueReceive(this_mixer->command_queue_, &command_event, 0) == pdTRUE) {
+    // While a block is held for the output hardware to wake, block on the command queue for the rest of the allowed
+    // latency, so OUTPUT_AWAKE is handled as soon as it arrives
+    TickType_t command_ticks_to_wait = 0;
+    if (waiting_for_output_wake) {
+      uint32_t wake_elapsed_ms = millis() - wake_request_ms;
+      if (wake_elapsed_ms < this_mixer->max_wake_latency_ms_) {
+        command_ticks_to_wait =
+            std::max<TickType_t>(1, pdMS_TO_TICKS(this_mixer->max_wake_latency_ms_ - wake_elapsed_ms));
+      }
+    }
+
+    if (xQueueReceive(this_mixer->command_queue_, &command_event, command_ticks_to_wait) == pdTRUE) {
       if (command_event.command == CommandEventType::STOP) {
         break;
       } else if (command_event.command == CommandEventType::DUCK) {
@@ -129,13 +169,10 @@ void AudioMixer::audio_mixer_task_(void *params) {
             total_ducking_steps = current_ducking_db_reduction - target_ducking_db_reduction - 1;
             db_change_per_ducking_step = -1;
           }
-          if (total_ducking_steps > 0) {
-            ducking_transition_samples_remaining = command_event.transition_samples;
-
-            samples_per_ducking_step = ducking_transition_samples_remaining / total_ducking_steps;
-          } else {
-            ducking_transition_samples_remaining = 0;
-          }
+          samples_per_ducking_step =
+              (total_ducking_steps > 0) ? command_event.transition_samples / total_ducking_steps : 0;
+          // A whole number of steps, so the transition ends exactly one step short of the target level
+          ducking_transition_samples_remaining = samples_per_ducking_step * total_ducking_steps;
         }
       } else if (command_event.command == CommandEventType::PAUSE_MEDIA) {
         transfer_media = false;
@@ -145,36 +182,54 @@ void AudioMixer::audio_mixer_task_(void *params) {
         this_mixer->media_ring_buffer_->reset();
       } else if (command_event.command == CommandEventType::CLEAR_ANNOUNCEMENT) {
         this_mixer->announcement_ring_buffer_->reset();
+      } else if (command_event.command == CommandEventType::OUTPUT_AWAKE) {
+        // Measured from the first audible block to the output hardware finishing its power up
+        uint32_t wake_latency_ms = millis() - wake_request_ms;
+        if (wake_latency_ms > this_mixer->max_wake_latency_ms_) {
+          ESP_LOGW(TAG, "Output took %" PRIu32 " ms to wake from standby, exceeding the %" PRIu32 " ms limit",
+                   wake_latency_ms, this_mixer->max_wake_latency_ms_);
+        } else {
+          ESP_LOGD(TAG, "Output woke from standby in %" PRIu32 " ms", wake_latency_ms);
+        }
+        waiting_for_output_wake = false;
       }
     }
 
-    if (combination_buffer_length > 0) {
-      size_t output_bytes_written = this_mixer->speaker_->play((uint8_t *) combination_buffer,
-                                                               combination_buffer_length, pdMS_TO_TICKS(TASK_DELAY_MS));
-      combination_buffer_length -= output_bytes_written;
-      if ((combination_buffer_length > 0) && (output_bytes_written > 0)) {
-        memmove(combination_buffer, combination_buffer + output_bytes_written / sizeof(int16_t),
-                combination_buffer_length);
+    if (waiting_for_output_wake) {
+      // Hold the first audible block until the output hardware is awake, but never longer than the maximum latency
+      if (millis() - wake_request_ms >= this_mixer->max_wake_latency_ms_) {
+        waiting_for_output_wake = false;
       }
+    } else if (combination_buffer_length > 0) {
+      size_t output_bytes_written = this_mixer->speaker_->play(
+          (uint8_t *) combination_buffer_current, combination_buffer_length, pdMS_TO_TICKS(task_delay_ms));
+      // Track the unwritten position on partial writes instead of shifting the remaining samples
+      combination_buffer_length -= output_bytes_written;
+      combination_buffer_current += output_bytes_written / sizeof(int16_t);
     } else {
+      combination_buffer_current = combination_buffer;
+
       size_t media_available = this_mixer->media_ring_buffer_->available();
       size_t announcement_available = this_mixer->announcement_ring_buffer_->available();
 
       if (media_available * transfer_media + announcement_available > 0) {
-        size_t bytes_to_read = OUTPUT_BUFFER_SAMPLES * sizeof(int16_t);
+        uint32_t block_start_us = micros();
 
-        if (media_available * transfer_media > 0) {
-          bytes_to_read = std::min(bytes_to_read, media_available);
-        }
+        // Each stream is consumed independently at the output rate. The block is sized by the stream with the most
+        // audio available, so a slowly arriving stream never throttles the other. A stream that can't fill the block
+        // is padded with silence and counted as an underrun.
+        size_t bytes_to_read = std::min(block_samples * sizeof(int16_t),
+                                        std::max(media_available * transfer_media, announcement_available));
 
-        if (announcement_available > 0) {
-          bytes_to_read = std::min(bytes_to_read, announcement_available);
-        }
+        // A lone stream is read (and ducked) directly in the combination buffer, so it is only copied once
+        const bool mix_streams = (media_available * transfer_media > 0) && (announcement_available > 0);
+        int16_t *media_destination = mix_streams ? media_buffer : combination_buffer;
+        int16_t *announcement_destination = mix_streams ? announcement_buffer : combination_buffer;
 
         if (bytes_to_read > 0) {
           size_t media_bytes_read = 0;
           if (media_available * transfer_media > 0) {
-            media_bytes_read = this_mixer->media_ring_buffer_->read((void *) media_buffer, bytes_to_read, 0);
+            media_bytes_read = this_mixer->media_ring_buffer_->read((void *) media_destination, bytes_to_read, 0);
             if (media_bytes_read > 0) {
               size_t samples_read = media_bytes_read / sizeof(int16_t);
               if (ducking_transition_samples_remaining > 0) {
@@ -183,7 +238,7 @@ void AudioMixer::audio_mixer_task_(void *params) {
                 size_t samples_left = ducking_transition_samples_remaining;
 
                 // There may be more than one step worth of samples to duck in the buffers, so manage positions
-                int16_t *current_media_buffer = media_buffer;
+                int16_t *current_media_buffer = media_destination;
 
                 size_t samples_left_in_step = samples_left % samples_per_ducking_step;
                 if (samples_left_in_step == 0) {
@@ -194,8 +249,6 @@ void AudioMixer::audio_mixer_task_(void *params) {
                 }
                 size_t samples_left_to_duck = std::min(samples_left_in_step, samples_read);
 
-                size_t total_samples_ducked = 0;
-
                 while (samples_left_to_duck > 0) {
                   // Ensure we only point to valid index in the Q15 scaling factor table
                   uint8_t safe_db_reduction_index =
@@ -210,7 +263,10 @@ void AudioMixer::audio_mixer_task_(void *params) {
                   samples_read -= samples_left_to_duck;
                   samples_left -= samples_left_to_duck;
 
-                  total_samples_ducked += samples_left_to_duck;
+                  if ((samples_left == 0) || (samples_read == 0)) {
+                    // The transition is complete, or the next block starts the next step
+                    break;
+                  }
 
                   samples_left_in_step = samples_left % samples_per_ducking_step;
                   if (samples_left_in_step == 0) {
@@ -221,6 +277,20 @@ void AudioMixer::audio_mixer_task_(void *params) {
                   }
                   samples_left_to_duck = std::min(samples_left_in_step, samples_read);
                 }
+
+                // Only media samples that were actually read advance the transition; zero-filled underruns and
+                // announcement-only blocks leave it where it is
+                ducking_transition_samples_remaining = samples_left;
+
+                if ((samples_read > 0) && (target_ducking_db_reduction > 0)) {
+                  // The transition finished partway through the block, so duck the rest at the target level
+                  uint8_t safe_db_reduction_index =
+                      clamp<uint8_t>(target_ducking_db_reduction, 0, decibel_reduction_table.size() - 1);
+
+                  int16_t q15_scale_factor = decibel_reduction_table[safe_db_reduction_index];
+                  this_mixer->scale_audio_samples_(current_media_buffer, current_media_buffer, q15_scale_factor,
+                                                   samples_read);
+                }
               } else if (target_ducking_db_reduction > 0) {
                 // We still need to apply a ducking scaling, but we are done transitioning
 
@@ -228,7 +298,8 @@ void AudioMixer::audio_mixer_task_(void *params) {
                     clamp<uint8_t>(target_ducking_db_reduction, 0, decibel_reduction_table.size() - 1);
 
                 int16_t q15_scale_factor = decibel_reduction_table[safe_db_reduction_index];
-                this_mixer->scale_audio_samples_(media_buffer, media_buffer, q15_scale_factor, samples_read);
+                this_mixer->scale_audio_samples_(media_destination, media_destination, q15_scale_factor,
+                                                 samples_read);
               }
             }
           }
@@ -236,52 +307,102 @@ void AudioMixer::audio_mixer_task_(void *params) {
           size_t announcement_bytes_read = 0;
           if (announcement_available > 0) {
             announcement_bytes_read =
-                this_mixer->announcement_ring_buffer_->read((void *) announcement_buffer, bytes_to_read, 0);
+                this_mixer->announcement_ring_buffer_->read((void *) announcement_destination, bytes_to_read, 0);
           }
 
-          if ((media_bytes_read > 0) && (announcement_bytes_read > 0)) {
+          if (mix_streams) {
             // We have both a media and an announcement stream, so mix them together
 
+            // Zero-fill whichever stream underran so both contribute a full block
+            if (media_bytes_read < bytes_to_read) {
+              memset((uint8_t *) media_buffer + media_bytes_read, 0, bytes_to_read - media_bytes_read);
+              stats_media_underrun_samples += (bytes_to_read - media_bytes_read) / sizeof(int16_t);
+            }
+            if (announcement_bytes_read < bytes_to_read) {
+              memset((uint8_t *) announcement_buffer + announcement_bytes_read, 0,
+                     bytes_to_read - announcement_bytes_read);
+              stats_announcement_underrun_samples += (bytes_to_read - announcement_bytes_read) / sizeof(int16_t);
+            }
+
             size_t samples_read = bytes_to_read / sizeof(int16_t);
 
             this_mixer->mix_audio_samples_without_clipping_(media_buffer, announcement_buffer, combination_buffer,
                                                             samples_read);
 
             combination_buffer_length = samples_read * sizeof(int16_t);
-          } else if (media_bytes_read > 0) {
-            memcpy(combination_buffer, media_buffer, media_bytes_read);
-            combination_buffer_length = media_bytes_read;
-          } else if (announcement_bytes_read > 0) {
-            memcpy(combination_buffer, announcement_buffer, announcement_bytes_read);
-            combination_buffer_length = announcement_bytes_read;
+          } else {
+            // Only one stream was read, and it is already in the combination buffer
+            combination_buffer_length = media_bytes_read + announcement_bytes_read;
           }
 
-          size_t samples_written = combination_buffer_length / sizeof(int16_t);
-          if (ducking_transition_samples_remaining > 0) {
-            ducking_transition_samples_remaining -= std::min(samples_written, ducking_transition_samples_remaining);
+          if (standby_enabled && (combination_buffer_length > 0)) {
+            if (!this_mixer->is_silent_(combination_buffer, combination_buffer_length / sizeof(int16_t))) {
+              last_audible_ms = millis();
+              if (output_in_standby) {
+                // Request the output hardware wake up before writing this block
+                output_in_standby = false;
+                waiting_for_output_wake = true;
+                wake_request_ms = millis();
+
+                event.type = EventType::RUNNING;
+                event.err = ESP_OK;
+                xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
+              }
+            } else if (output_in_standby) {
+              // Drop silent audio while in standby
+              combination_buffer_length = 0;
+            }
           }
+
+          stats_processing_us += micros() - block_start_us;
+          ++stats_blocks_mixed;
         }
       } else {
         // No audio data available in either buffer
 
-        delay(TASK_DELAY_MS);
+        delay(task_delay_ms);
       }
     }
+
+    if (standby_enabled && !output_in_standby && !waiting_for_output_wake && (combination_buffer_length == 0) &&
+        (millis() - last_audible_ms > this_mixer->standby_timeout_ms_)) {
+      // Output has been silent long enough, request the output hardware enter standby
+      output_in_standby = true;
+
+      event.type = EventType::IDLE;
+      event.err = ESP_OK;
+      xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
+    }
+
+    if ((stats_blocks_mixed > 0) && (millis() - stats_last_report_ms > STATS_REPORT_INTERVAL_MS)) {
+      ESP_LOGV(TAG, "Mixed %" PRIu32 " blocks of %zu samples (%" PRIu32 " ms); average processing time %" PRIu32 " us",
+               stats_blocks_mixed, block_samples, this_mixer->block_duration_ms_,
+               stats_processing_us / stats_blocks_mixed);
+      if ((stats_media_underrun_samples > 0) || (stats_announcement_underrun_samples > 0)) {
+        ESP_LOGV(TAG, "Zero-filled %" PRIu32 " media and %" PRIu32 " announcement samples due to underruns",
+                 stats_media_underrun_samples, stats_announcement_underrun_samples);
+      }
+      stats_blocks_mixed = 0;
+      stats_processing_us = 0;
+      stats_media_underrun_samples = 0;
+      stats_announcement_underrun_samples = 0;
+      stats_last_report_ms = millis();
+    }
   }
 
   event.type = EventType::STOPPING;
   xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
 
   this_mixer->reset_ring_buffers_();
-  allocator.deallocate(media_buffer, OUTPUT_BUFFER_SAMPLES);
-  allocator.deallocate(announcement_buffer, OUTPUT_BUFFER_SAMPLES);
-  allocator.deallocate(combination_buffer, OUTPUT_BUFFER_SAMPLES);
+  allocator.deallocate(media_buffer, block_samples);
+  allocator.deallocate(announcement_buffer, block_samples);
+  allocator.deallocate(combination_buffer, block_samples);
 
   event.type = EventType::STOPPED;
   xQueueSend(this_mixer->event_queue_, &event, portMAX_DELAY);
 
   while (true) {
-    delay(TASK_DELAY_MS);
+    delay(task_delay_ms);
   }
 }
 
@@ -371,6 +492,15 @@ void AudioMixer::mix_audio_samples_without_clipping_(int16_t *media_buffer, int1
   }
 }
 
+bool AudioMixer::is_silent_(const int16_t *audio_samples, size_t samples_to_check) {
+  for (size_t i = 0; i < samples_to_check; ++i) {
+    if ((audio_samples[i] > SILENCE_THRESHOLD) || (audio_samples[i] < -SILENCE_THRESHOLD)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void AudioMixer::scale_audio_samples_(int16_t *audio_samples, int16_t *output_buffer, int16_t scale_factor,
                                       size_t samples_to_scale) {
   // Scale the audio samples and store them in the output buffer
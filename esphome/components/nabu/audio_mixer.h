@@ -24,7 +24,18 @@ namespace nabu {
 //    - Unable to pause
 //  - Each stream has a corresponding input ring buffer. Retrieved via the `get_media_ring_buffer` and
 //    `get_announcement_ring_buffer` functions
-//  - The mixed audio is sent to the configured speaker component.
+//  - The mixed audio is sent to the configured speaker component. Each block is written to the combination buffer once
+//    and handed to `Speaker::play`, which copies it into the speaker's own buffer. The speaker component can't lend
+//    writable spans of that buffer, so this final copy remains.
+//  - Audio is read, ducked, and mixed in blocks. The block size is configurable via `set_block_size`; smaller blocks
+//    lower the announcement latency and make ducking/pausing react faster at the cost of more per-block overhead.
+//  - When both streams are playing, each is consumed independently at the output rate. If one stream underruns, it
+//    is padded with silence rather than stalling the other stream.
+//  - Optionally, the mixer detects when its output has been silent for a configured time and requests the output
+//    hardware enter standby (via an IDLE event). Speaker writes stop while in standby. The first audible block
+//    requests a wake (via a RUNNING event) and is held until the OUTPUT_AWAKE command arrives or the maximum wake
+//    latency passes. The task blocks on the command queue while it waits. Send OUTPUT_AWAKE once the output hardware
+//    has finished powering up; the logged wake latency runs from the first audible block to that command.
 //  - The mixer runs as a FreeRTOS task
 //    - The task reports its state using the TaskEvent queue. Regularly call the  `read_event` function to obtain the
 //      current state
@@ -35,8 +46,8 @@ namespace nabu {
 enum class EventType : uint8_t {
   STARTING = 0,
   STARTED,
-  RUNNING,
-  IDLE,
+  RUNNING,  // Audible audio is ready after standby; the output hardware should be woken
+  IDLE,     // The output has been silent long enough for the output hardware to enter standby
   STOPPING,
   STOPPED,
   WARNING = 255,
@@ -55,6 +66,7 @@ enum class CommandEventType : uint8_t {
   RESUME_MEDIA,        // Resumes the media stream
   CLEAR_MEDIA,         // Resets the media ring buffer
   CLEAR_ANNOUNCEMENT,  // Resets the announcement ring buffer
+  OUTPUT_AWAKE,        // The output hardware is powered up after leaving standby
 };
 
 // Used to send commands to the mixer task
@@ -97,6 +109,22 @@ class AudioMixer {
   /// @return ESP_OK if successful, and error otherwise
   esp_err_t start(speaker::Speaker *speaker, const std::string &task_name, UBaseType_t priority = 1);
 
+  /// @brief Sets the number of samples read, ducked, and mixed per block. Must be called before `start`.
+  /// @param block_samples Number of samples (summed over all channels) in each block
+  /// @param block_duration_ms Playback duration of one block in milliseconds. Used to pace the task's waits.
+  void set_block_size(size_t block_samples, uint32_t block_duration_ms) {
+    this->block_samples_ = block_samples;
+    this->block_duration_ms_ = block_duration_ms;
+  }
+
+  /// @brief Enables entering standby when the mixed output is silent. Must be called before `start`.
+  /// @param standby_timeout_ms Duration of silence before requesting standby
+  /// @param max_wake_latency_ms Maximum time to hold audio while waiting for the output hardware to wake
+  void set_standby_timeout(uint32_t standby_timeout_ms, uint32_t max_wake_latency_ms) {
+    this->standby_timeout_ms_ = standby_timeout_ms;
+    this->max_wake_latency_ms_ = max_wake_latency_ms;
+  }
+
   /// @brief Stops the mixer task and clears the queues
   void stop();
 
@@ -129,6 +157,12 @@ class AudioMixer {
   void mix_audio_samples_without_clipping_(int16_t *media_buffer, int16_t *announcement_buffer,
                                            int16_t *combination_buffer, size_t samples_to_mix);
 
+  /// @brief Determines if every sample in the buffer is effectively silent
+  /// @param audio_samples PCM int16 audio samples
+  /// @param samples_to_check Number of samples to check
+  /// @return true if all samples are below the silence threshold, false otherwise
+  bool is_silent_(const int16_t *audio_samples, size_t samples_to_check);
+
   /// @brief Scales audio samples. Scales in place when audio_samples == output_buffer.
   /// @param audio_samples PCM int16 audio samples
   /// @param output_buffer Buffer to store the scaled samples
@@ -150,6 +184,15 @@ class AudioMixer {
 
   speaker::Speaker *speaker_{nullptr};
 
+  // Defaults to 8192 samples; i.e., roughly 85 ms of 48 kHz stereo audio. This is the block size used before it became
+  // configurable, deliberately left untuned until the per-block overhead has been measured on hardware.
+  size_t block_samples_{8192};
+  uint32_t block_duration_ms_{85};
+
+  // Standby is disabled if the timeout is 0
+  uint32_t standby_timeout_ms_{0};
+  uint32_t max_wake_latency_ms_{0};
+
   std::unique_ptr<RingBuffer> media_ring_buffer_;
   std::unique_ptr<RingBuffer> announcement_ring_buffer_;
 };
@@ -19,10 +19,13 @@ static const uint32_t RESAMPLER_TASK_STACK_SIZE = 3 * 1024;
 
 static const size_t INFO_ERROR_QUEUE_COUNT = 5;
 
+// How long the tasks have to stop before each one that hasn't is reported as an error
+static const uint32_t STOP_TIMEOUT_MS = 300;
+
 static const char *const TAG = "nabu_media_player.pipeline";
 
 enum EventGroupBits : uint32_t {
-  // The stop() function clears all unfinished bits
+  // Completing a stop clears all unfinished bits
   // MESSAGE_* bits are only set by their respective tasks
 
   // Stops all activity in the pipeline elements and set by stop() or by each task
@@ -68,8 +71,12 @@ esp_err_t AudioPipeline::start(const std::string &uri, uint32_t target_sample_ra
   esp_err_t err = this->common_start_(target_sample_rate, task_name, priority);
 
   if (err == ESP_OK) {
-    this->current_uri_ = uri;
-    xEventGroupSetBits(this->event_group_, READER_COMMAND_INIT_HTTP);
+    this->pending_uri_ = uri;
+    this->pending_media_file_ = nullptr;
+    this->start_pending_ = true;
+
+    // Starts right away if the tasks were already idle
+    this->advance_start_stop_();
   }
 
   return err;
@@ -80,8 +87,11 @@ esp_err_t AudioPipeline::start(media_player::MediaFile *media_file, uint32_t tar
   esp_err_t err = this->common_start_(target_sample_rate, task_name, priority);
 
   if (err == ESP_OK) {
-    this->current_media_file_ = media_file;
-    xEventGroupSetBits(this->event_group_, READER_COMMAND_INIT_FILE);
+    this->pending_media_file_ = media_file;
+    this->start_pending_ = true;
+
+    // Starts right away if the tasks were already idle
+    this->advance_start_stop_();
   }
 
   return err;
@@ -130,6 +140,12 @@ esp_err_t AudioPipeline::allocate_buffers_() {
 
 esp_err_t AudioPipeline::common_start_(uint32_t target_sample_rate, const std::string &task_name,
                                        UBaseType_t priority) {
+  if (this->stopping_ && this->stop_timed_out_) {
+    // The previous stream's tasks are stuck, so a queued start could never begin; report it instead of waiting forever
+    ESP_LOGE(TAG, "Pipeline tasks still haven't stopped; rejecting the new stream");
+    return ESP_ERR_INVALID_STATE;
+  }
+
   esp_err_t err = this->allocate_buffers_();
   if (err != ESP_OK) {
     return err;
@@ -156,12 +172,28 @@ esp_err_t AudioPipeline::common_start_(uint32_t target_sample_rate, const std::s
     return ESP_FAIL;
   }
 
-  this->target_sample_rate_ = target_sample_rate;
+  if (this->parallel_flac_decoding_) {
+    if (this->flac_frame_worker_ == nullptr) {
+      this->flac_frame_worker_ = make_unique<FLACFrameWorker>();
+    }
+    err = this->flac_frame_worker_->start(task_name + "_flac", priority);
+    if (err != ESP_OK) {
+      return err;
+    }
+  }
+
+  // Stopping the current stream cancels any earlier pending start; the caller then queues the new source
+  this->stop();
+  this->pending_target_sample_rate_ = target_sample_rate;
 
-  return this->stop();
+  return ESP_OK;
 }
 
 AudioPipelineState AudioPipeline::get_state() {
+  if (this->event_group_ != nullptr) {
+    this->advance_start_stop_();
+  }
+
   InfoErrorEvent event;
   if (this->info_error_queue_ != nullptr) {
     while (xQueueReceive(this->info_error_queue_, &event, 0)) {
@@ -236,6 +268,15 @@ AudioPipelineState AudioPipeline::get_state() {
     return AudioPipelineState::ERROR_RESAMPLING;
   }
 
+  if (this->stopping_) {
+    return this->start_pending_ ? AudioPipelineState::STARTING : AudioPipelineState::STOPPING;
+  }
+
+  if (event_bits & (READER_COMMAND_INIT_FILE | READER_COMMAND_INIT_HTTP)) {
+    // The reader hasn't picked up the new source yet
+    return AudioPipelineState::STARTING;
+  }
+
   if ((event_bits & READER_MESSAGE_FINISHED) && (event_bits & DECODER_MESSAGE_FINISHED) &&
       (event_bits & RESAMPLER_MESSAGE_FINISHED)) {
     return AudioPipelineState::STOPPED;
@@ -244,34 +285,79 @@ AudioPipelineState AudioPipeline::get_state() {
   return AudioPipelineState::PLAYING;
 }
 
-esp_err_t AudioPipeline::stop() {
-  xEventGroupSetBits(this->event_group_, PIPELINE_COMMAND_STOP);
+void AudioPipeline::stop() {
+  this->start_pending_ = false;
 
-  uint32_t event_group_bits = xEventGroupWaitBits(this->event_group_,
-                                                  FINISHED_BITS,        // Bit message to read
-                                                  pdFALSE,              // Clear the bits on exit
-                                                  pdTRUE,               // Wait for all the bits,
-                                                  pdMS_TO_TICKS(300));  // Duration to block/wait
-
-  if (!(event_group_bits & READER_MESSAGE_FINISHED)) {
-    // Reader failed to stop
-    xEventGroupSetBits(this->event_group_, EventGroupBits::READER_MESSAGE_ERROR);
+  if (this->event_group_ == nullptr) {
+    return;
   }
-  if (!(event_group_bits & DECODER_MESSAGE_FINISHED)) {
-    // Ddecoder failed to stop
-    xEventGroupSetBits(this->event_group_, EventGroupBits::DECODER_MESSAGE_ERROR);
+
+  xEventGroupSetBits(this->event_group_, PIPELINE_COMMAND_STOP);
+
+  if (!this->stopping_) {
+    this->stopping_ = true;
+    this->stop_timed_out_ = false;
+    this->stop_requested_ms_ = millis();
   }
-  if (!(event_group_bits & RESAMPLER_MESSAGE_FINISHED)) {
-    // Resampler failed to stop
-    xEventGroupSetBits(this->event_group_, EventGroupBits::RESAMPLER_MESSAGE_ERROR);
+
+  // Drop what the mixer already holds so a new stream doesn't start with the old one's audio. It is cleared again
+  // once the tasks have stopped, as the resampler may still write a block while it stops.
+  this->clear_mixer_buffer_();
+}
+
+void AudioPipeline::advance_start_stop_() {
+  if (!this->stopping_) {
+    return;
   }
 
-  if ((event_group_bits & FINISHED_BITS) != FINISHED_BITS) {
-    // Not all bits were set, so it timed out
-    return ESP_ERR_TIMEOUT;
+  EventBits_t event_bits = xEventGroupGetBits(this->event_group_);
+
+  if ((event_bits & FINISHED_BITS) != FINISHED_BITS) {
+    if (!this->stop_timed_out_ && (millis() - this->stop_requested_ms_ > STOP_TIMEOUT_MS)) {
+      this->stop_timed_out_ = true;
+
+      // Report each task that failed to stop and give up on the pending start; keep waiting for the tasks to finish
+      if (!(event_bits & READER_MESSAGE_FINISHED)) {
+        xEventGroupSetBits(this->event_group_, EventGroupBits::READER_MESSAGE_ERROR);
+      }
+      if (!(event_bits & DECODER_MESSAGE_FINISHED)) {
+        xEventGroupSetBits(this->event_group_, EventGroupBits::DECODER_MESSAGE_ERROR);
+      }
+      if (!(event_bits & RESAMPLER_MESSAGE_FINISHED)) {
+        xEventGroupSetBits(this->event_group_, EventGroupBits::RESAMPLER_MESSAGE_ERROR);
+      }
+      if (this->start_pending_) {
+        ESP_LOGE(TAG, "Pipeline tasks did not stop within %" PRIu32 " ms; dropping the new stream", STOP_TIMEOUT_MS);
+        this->start_pending_ = false;
+      }
+    }
+    return;
   }
 
+  // Every task has stopped
+  this->stopping_ = false;
+
   // Clear the ring buffer in the mixer; avoids playing incorrect audio when starting a new file while paused
+  this->clear_mixer_buffer_();
+
+  xEventGroupClearBits(this->event_group_, UNFINISHED_BITS);
+  this->reset_ring_buffers();
+
+  if (this->start_pending_) {
+    this->start_pending_ = false;
+    this->target_sample_rate_ = this->pending_target_sample_rate_;
+
+    if (this->pending_media_file_ != nullptr) {
+      this->current_media_file_ = this->pending_media_file_;
+      xEventGroupSetBits(this->event_group_, READER_COMMAND_INIT_FILE);
+    } else {
+      this->current_uri_ = this->pending_uri_;
+      xEventGroupSetBits(this->event_group_, READER_COMMAND_INIT_HTTP);
+    }
+  }
+}
+
+void AudioPipeline::clear_mixer_buffer_() {
   CommandEvent command_event;
   if (this->pipeline_type_ == AudioPipelineType::MEDIA) {
     command_event.command = CommandEventType::CLEAR_MEDIA;
@@ -279,11 +365,6 @@ esp_err_t AudioPipeline::stop() {
     command_event.command = CommandEventType::CLEAR_ANNOUNCEMENT;
   }
   this->mixer_->send_command(&command_event);
-
-  xEventGroupClearBits(this->event_group_, UNFINISHED_BITS);
-  this->reset_ring_buffers();
-
-  return ESP_OK;
 }
 
 void AudioPipeline::reset_ring_buffers() {
@@ -301,6 +382,9 @@ void AudioPipeline::suspend_tasks() {
   if (this->resample_task_handle_ != nullptr) {
     vTaskSuspend(this->resample_task_handle_);
   }
+  if ((this->flac_frame_worker_ != nullptr) && (this->flac_frame_worker_->get_task_handle() != nullptr)) {
+    vTaskSuspend(this->flac_frame_worker_->get_task_handle());
+  }
 }
 
 void AudioPipeline::resume_tasks() {
@@ -313,6 +397,9 @@ void AudioPipeline::resume_tasks() {
   if (this->resample_task_handle_ != nullptr) {
     vTaskResume(this->resample_task_handle_);
   }
+  if ((this->flac_frame_worker_ != nullptr) && (this->flac_frame_worker_->get_task_handle() != nullptr)) {
+    vTaskResume(this->flac_frame_worker_->get_task_handle());
+  }
 }
 
 void AudioPipeline::read_task_(void *params) {
@@ -402,6 +489,9 @@ void AudioPipeline::decode_task_(void *params) {
 
       std::unique_ptr<AudioDecoder> decoder = make_unique<AudioDecoder>(
           this_pipeline->raw_file_ring_buffer_.get(), this_pipeline->decoded_ring_buffer_.get(), FILE_BUFFER_SIZE);
+      if (this_pipeline->flac_frame_worker_ != nullptr) {
+        decoder->set_flac_frame_worker(this_pipeline->flac_frame_worker_.get());
+      }
       esp_err_t err = decoder->start(this_pipeline->current_media_file_type_);
 
       if (err != ESP_OK) {
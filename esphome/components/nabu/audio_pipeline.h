@@ -27,7 +27,9 @@ enum class AudioPipelineType : uint8_t {
 };
 
 enum class AudioPipelineState : uint8_t {
+  STARTING,  // A start was requested; waiting for the previous stream to stop or for the reader to pick it up
   PLAYING,
+  STOPPING,  // A stop was requested; waiting for the tasks to finish
   STOPPED,
   ERROR_READING,
   ERROR_DECODING,
@@ -60,6 +62,11 @@ class AudioPipeline {
  public:
   AudioPipeline(AudioMixer *mixer, AudioPipelineType pipeline_type);
 
+  // Starting and stopping never block the caller. The tasks finish their current stream in the background, and
+  // ``get_state`` (called from the component's loop) completes the transition once they have. A start requested while
+  // the previous stream is still stopping replaces any earlier pending start, so only the newest source plays. Once a
+  // stop has timed out, starts fail with ESP_ERR_INVALID_STATE until the stuck tasks finish.
+
   /// @brief Starts an audio pipeline given a media url
   /// @param uri media file url
   /// @param target_sample_rate the desired sample rate of the audio stream
@@ -78,11 +85,19 @@ class AudioPipeline {
   esp_err_t start(media_player::MediaFile *media_file, uint32_t target_sample_rate, const std::string &task_name,
                   UBaseType_t priority = 1);
 
-  /// @brief Stops the pipeline. Sends a stop signal to each task (if running) and clears the ring buffers.
-  /// @return ESP_OK if successful or ESP_ERR_TIMEOUT if the tasks did not indicate they stopped
-  esp_err_t stop();
+  /// @brief Decodes FLAC streams two frames at a time with a worker task, so both cores share the decoding load.
+  /// Takes effect the next time the pipeline starts.
+  void set_parallel_flac_decoding(bool parallel_flac_decoding) {
+    this->parallel_flac_decoding_ = parallel_flac_decoding;
+  }
+
+  /// @brief Requests the pipeline to stop and returns immediately. Sends a stop signal to each task (if running) and
+  /// cancels any pending start. The ring buffers are cleared once the tasks have stopped. If they don't stop within
+  /// 300 ms, ``get_state`` reports an error for each task that is still running.
+  void stop();
 
-  /// @brief Gets the state of the audio pipeline based on the info_error_queue_ and event_group_
+  /// @brief Gets the state of the audio pipeline based on the info_error_queue_ and event_group_. Completes any
+  /// pending stop and start.
   /// @return AudioPipelineState
   AudioPipelineState get_state();
 
@@ -106,6 +121,13 @@ class AudioPipeline {
   /// @return ESP_OK if successful or an appropriate error if not
   esp_err_t common_start_(uint32_t target_sample_rate, const std::string &task_name, UBaseType_t priority);
 
+  /// @brief Finishes a requested stop once every task has reported it is done, then starts the pending source (if
+  /// any). Doesn't block.
+  void advance_start_stop_();
+
+  /// @brief Clears this pipeline's input ring buffer in the mixer
+  void clear_mixer_buffer_();
+
   // Pointer to the media player's mixer object. The resample task feeds the appropriate ring buffer directly
   AudioMixer *mixer_;
 
@@ -119,9 +141,23 @@ class AudioPipeline {
 
   AudioPipelineType pipeline_type_;
 
+  bool stopping_{false};
+  bool stop_timed_out_{false};
+  uint32_t stop_requested_ms_{0};
+
+  // Source to play once the previous stream has stopped; only the newest request is kept
+  bool start_pending_{false};
+  std::string pending_uri_{};
+  media_player::MediaFile *pending_media_file_{nullptr};
+  uint32_t pending_target_sample_rate_{0};
+
   std::unique_ptr<RingBuffer> raw_file_ring_buffer_;
   std::unique_ptr<RingBuffer> decoded_ring_buffer_;
 
+  bool parallel_flac_decoding_{false};
+  // Only created if parallel FLAC decoding is enabled; the decode task hands it every second frame
+  std::unique_ptr<FLACFrameWorker> flac_frame_worker_;
+
   // Handles basic control/state of the three tasks
   EventGroupHandle_t event_group_{nullptr};
 
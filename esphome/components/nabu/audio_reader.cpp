@@ -2,6 +2,9 @@
 
 #include "audio_reader.h"
 
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
 #include "esphome/core/ring_buffer.h"
 
 #if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
@@ -16,6 +19,87 @@ static const size_t READ_WRITE_TIMEOUT_MS = 20;
 // The number of times the http read times out with no data before throwing an error
 static const size_t ERROR_COUNT_NO_DATA_READ_TIMEOUT = 50;
 
+static const char *const TAG = "nabu_media_player.reader";
+
+// The media and announcement pipelines read from separate tasks
+static Mutex tls_session_mutex;
+static TLSSessionStats tls_session_stats;
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// HTTPS clients are kept after their stream ends. A client's transport holds the TLS session from its last
+// connection, so reopening it to the same host resumes that session with an abbreviated handshake. Each idle client
+// keeps only its small HTTP buffers allocated.
+static const size_t TLS_SESSION_CACHE_SIZE = 2;
+
+struct CachedClient {
+  std::string host;
+  esp_http_client_handle_t client{nullptr};
+  uint32_t last_used_ms{0};
+};
+
+static CachedClient tls_session_cache[TLS_SESSION_CACHE_SIZE];
+
+static esp_http_client_handle_t take_cached_client(const std::string &host) {
+  LockGuard lock(tls_session_mutex);
+  for (auto &entry : tls_session_cache) {
+    if ((entry.client != nullptr) && (entry.host == host)) {
+      esp_http_client_handle_t client = entry.client;
+      entry.client = nullptr;
+      return client;
+    }
+  }
+  return nullptr;
+}
+
+static void store_cached_client(const std::string &host, esp_http_client_handle_t client) {
+  esp_http_client_handle_t evicted = nullptr;
+  {
+    LockGuard lock(tls_session_mutex);
+    // Prefer a free entry, otherwise replace the least recently used one
+    CachedClient *target = &tls_session_cache[0];
+    for (auto &entry : tls_session_cache) {
+      if (entry.client == nullptr) {
+        target = &entry;
+        break;
+      }
+      if (entry.last_used_ms < target->last_used_ms) {
+        target = &entry;
+      }
+    }
+    evicted = target->client;
+    target->host = host;
+    target->client = client;
+    target->last_used_ms = millis();
+  }
+  if (evicted != nullptr) {
+    esp_http_client_cleanup(evicted);
+  }
+}
+#endif
+
+// Returns the host and port of an HTTPS URI, or an empty string for any other scheme
+static std::string https_host(const std::string &uri) {
+  static const char *const HTTPS_SCHEME = "https://";
+  if (uri.compare(0, strlen(HTTPS_SCHEME), HTTPS_SCHEME) != 0) {
+    return "";
+  }
+  size_t start = strlen(HTTPS_SCHEME);
+  size_t end = uri.find_first_of("/?#", start);
+  std::string authority = uri.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+  // Drop any credentials
+  size_t at = authority.rfind('@');
+  if (at != std::string::npos) {
+    authority.erase(0, at + 1);
+  }
+  return authority;
+}
+
+TLSSessionStats AudioReader::get_tls_session_stats() {
+  LockGuard lock(tls_session_mutex);
+  return tls_session_stats;
+}
+
 AudioReader::AudioReader(esphome::RingBuffer *output_ring_buffer, size_t transfer_buffer_size) {
   this->output_ring_buffer_ = output_ring_buffer;
   this->transfer_buffer_size_ = transfer_buffer_size;
@@ -27,7 +111,7 @@ AudioReader::~AudioReader() {
     allocator.deallocate(this->transfer_buffer_, this->transfer_buffer_size_);
   }
 
-  this->cleanup_connection_();
+  this->cleanup_connection_(true);
 }
 
 esp_err_t AudioReader::allocate_buffers_() {
@@ -44,6 +128,11 @@ esp_err_t AudioReader::allocate_buffers_() {
 esp_err_t AudioReader::start(media_player::MediaFile *media_file, media_player::MediaFileType &file_type) {
   file_type = media_player::MediaFileType::NONE;
 
+  if (media_file->data == nullptr) {
+    // The file is stored in the asset partition, but it wasn't found there
+    return ESP_ERR_NOT_FOUND;
+  }
+
   esp_err_t err = this->allocate_buffers_();
   if (err != ESP_OK) {
     return err;
@@ -66,7 +155,7 @@ esp_err_t AudioReader::start(const std::string &uri, media_player::MediaFileType
     return err;
   }
 
-  this->cleanup_connection_();
+  this->cleanup_connection_(true);
 
   if (uri.empty()) {
     return ESP_ERR_INVALID_ARG;
@@ -89,26 +178,72 @@ esp_err_t AudioReader::start(const std::string &uri, media_player::MediaFileType
   }
 #endif
 
-  this->client_ = esp_http_client_init(&client_config);
+  this->session_host_ = https_host(uri);
+  bool offered_session = false;
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+  if (!this->session_host_.empty()) {
+    client_config.save_client_session = true;
+
+    this->client_ = take_cached_client(this->session_host_);
+    if (this->client_ != nullptr) {
+      if (esp_http_client_set_url(this->client_, uri.c_str()) == ESP_OK) {
+        offered_session = true;
+      } else {
+        this->cleanup_connection_(false);
+      }
+    }
+  }
+#endif
+
+  if (this->client_ == nullptr) {
+    this->client_ = esp_http_client_init(&client_config);
+  }
 
   if (this->client_ == nullptr) {
     return ESP_FAIL;
   }
 
+  const uint32_t open_start_ms = millis();
+
   if ((err = esp_http_client_open(this->client_, 0)) != ESP_OK) {
-    this->cleanup_connection_();
+    this->cleanup_connection_(false);
     return err;
   }
 
   int content_length = esp_http_client_fetch_headers(this->client_);
+  const uint32_t ttfb_ms = millis() - open_start_ms;
 
   char url[500];
   err = esp_http_client_get_url(this->client_, url, 500);
   if (err != ESP_OK) {
-    this->cleanup_connection_();
+    this->cleanup_connection_(false);
     return err;
   }
 
+  if (!this->session_host_.empty()) {
+    TLSSessionStats stats;
+    {
+      LockGuard lock(tls_session_mutex);
+      if (offered_session) {
+        ++tls_session_stats.offered;
+        tls_session_stats.offered_ttfb_ms += ttfb_ms;
+      } else {
+        ++tls_session_stats.fresh;
+        tls_session_stats.fresh_ttfb_ms += ttfb_ms;
+      }
+      stats = tls_session_stats;
+    }
+    ESP_LOGD(TAG,
+             "%s TLS session to %s; first byte after %" PRIu32 " ms (%" PRIu32 " of %" PRIu32
+             " connections offered a session)",
+             offered_session ? "Offered a cached" : "No cached", this->session_host_.c_str(), ttfb_ms, stats.offered,
+             stats.offered + stats.fresh);
+  }
+
+  // After a redirect the client is connected to, and saves the session of, the final URL's host
+  this->session_host_ = https_host(url);
+
   std::string url_string = url;
 
   if (str_endswith(url_string, ".wav")) {
@@ -117,9 +252,11 @@ esp_err_t AudioReader::start(const std::string &uri, media_player::MediaFileType
     file_type = media_player::MediaFileType::MP3;
   } else if (str_endswith(url_string, ".flac")) {
     file_type = media_player::MediaFileType::FLAC;
+  } else if (str_endswith(url_string, ".qoa")) {
+    file_type = media_player::MediaFileType::QOA;
   } else {
     file_type = media_player::MediaFileType::NONE;
-    this->cleanup_connection_();
+    this->cleanup_connection_(true);
     return ESP_ERR_NOT_SUPPORTED;
   }
 
@@ -164,7 +301,7 @@ AudioReaderState AudioReader::http_read_() {
 
   if (esp_http_client_is_complete_data_received(this->client_)) {
     if (this->transfer_buffer_length_ == 0) {
-      this->cleanup_connection_();
+      this->cleanup_connection_(true);
       return AudioReaderState::FINISHED;
     }
   } else {
@@ -177,7 +314,7 @@ AudioReaderState AudioReader::http_read_() {
       this->no_data_read_count_ = 0;
     } else if (received_len < 0) {
       // HTTP read error
-      this->cleanup_connection_();
+      this->cleanup_connection_(false);
       return AudioReaderState::FAILED;
     } else {
       if (bytes_to_read > 0) {
@@ -185,7 +322,7 @@ AudioReaderState AudioReader::http_read_() {
         ++this->no_data_read_count_;
         if (this->no_data_read_count_ >= ERROR_COUNT_NO_DATA_READ_TIMEOUT) {
           // Timed out with no data read too many times, so the http read has failed
-          this->cleanup_connection_();
+          this->cleanup_connection_(false);
           return AudioReaderState::FAILED;
         }
         vTaskDelay(pdMS_TO_TICKS(READ_WRITE_TIMEOUT_MS));
@@ -196,9 +333,16 @@ AudioReaderState AudioReader::http_read_() {
   return AudioReaderState::READING;
 }
 
-void AudioReader::cleanup_connection_() {
+void AudioReader::cleanup_connection_(bool reuse_session) {
   if (this->client_ != nullptr) {
     esp_http_client_close(this->client_);
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (reuse_session && !this->session_host_.empty()) {
+      store_cached_client(this->session_host_, this->client_);
+      this->client_ = nullptr;
+      return;
+    }
+#endif
     esp_http_client_cleanup(this->client_);
     this->client_ = nullptr;
   }
@@ -16,6 +16,15 @@ enum class AudioReaderState : uint8_t {
   FAILED,
 };
 
+// The HTTP client doesn't expose whether the server accepted an offered session, so an offer may still have ended in a
+// full handshake
+struct TLSSessionStats {
+  uint32_t offered{0};          // HTTPS connections that offered a cached session to the server
+  uint32_t fresh{0};            // HTTPS connections without a cached session, so always a full handshake
+  uint32_t offered_ttfb_ms{0};  // Time to first byte summed over all connections that offered a session
+  uint32_t fresh_ttfb_ms{0};    // Time to first byte summed over all fresh connections
+};
+
 class AudioReader {
  public:
   AudioReader(esphome::RingBuffer *output_ring_buffer, size_t transfer_buffer_size);
@@ -26,13 +35,19 @@ class AudioReader {
 
   AudioReaderState read();
 
+  /// @brief Returns the TLS session cache counters shared by every reader
+  static TLSSessionStats get_tls_session_stats();
+
  protected:
   esp_err_t allocate_buffers_();
 
   AudioReaderState file_read_();
   AudioReaderState http_read_();
 
-  void cleanup_connection_();
+  /// @brief Closes the HTTP connection
+  /// @param reuse_session If true, an HTTPS client is kept in the session cache so the next connection to the same
+  /// host can resume its TLS session. Pass false after errors.
+  void cleanup_connection_(bool reuse_session);
 
   esphome::RingBuffer *output_ring_buffer_;
 
@@ -45,6 +60,9 @@ class AudioReader {
   const uint8_t *transfer_buffer_current_{nullptr};
 
   esp_http_client_handle_t client_{nullptr};
+  // Key of the TLS session cache entry for an HTTPS client; empty for plain HTTP. Once the headers arrive, it is the
+  // host of the final URL after redirects, since that is the server the client's saved session belongs to.
+  std::string session_host_;
 
   media_player::MediaFile *current_media_file_{nullptr};
 };
@@ -0,0 +1,913 @@
+#ifdef USE_ESP_IDF
+
+#include "flac_stream_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nabu {
+
+static const uint8_t STREAMINFO_BLOCK_TYPE = 0;
+static const uint8_t SEEKTABLE_BLOCK_TYPE = 3;
+static const size_t STREAMINFO_BLOCK_LENGTH = 34;
+static const size_t SEEK_POINT_LENGTH = 18;
+static const uint64_t PLACEHOLDER_SEEK_POINT = 0xFFFFFFFFFFFFFFFFULL;
+static const size_t MAX_SEEK_POINTS = 512;  // Bounds the memory a malicious or unusual file can claim
+static const size_t METADATA_BLOCK_HEADER_LENGTH = 4;
+static const size_t ID3V2_HEADER_LENGTH = 10;
+
+// Assignments 8, 9, and 10 store a side channel with one extra bit of depth
+static const uint8_t CHANNEL_ASSIGNMENT_LEFT_SIDE = 8;
+static const uint8_t CHANNEL_ASSIGNMENT_SIDE_RIGHT = 9;
+static const uint8_t CHANNEL_ASSIGNMENT_MID_SIDE = 10;
+
+static const uint8_t SUBFRAME_TYPE_CONSTANT = 0;
+static const uint8_t SUBFRAME_TYPE_VERBATIM = 1;
+static const uint8_t SUBFRAME_TYPE_FIXED_MIN = 8;
+static const uint8_t SUBFRAME_TYPE_FIXED_MAX = 12;
+static const uint8_t SUBFRAME_TYPE_LPC_MIN = 32;
+
+static const uint8_t MAX_LPC_ORDER = 32;
+
+// Frame header sample size codes; 0 means the STREAMINFO value, and 3 is reserved
+static const uint8_t SAMPLE_SIZE_TABLE[] = {0, 8, 12, 0, 16, 20, 24, 32};
+
+static uint8_t crc8(const uint8_t *data, size_t length) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+// CRC-16 with polynomial x^16 + x^15 + x^2 + 1, indexed by the high byte of the running CRC xor the next data byte
+static const uint16_t CRC16_TABLE[256] = {
+    0x0000, 0x8005, 0x800f, 0x000a, 0x801b, 0x001e, 0x0014, 0x8011, 0x8033, 0x0036, 0x003c, 0x8039,
+    0x0028, 0x802d, 0x8027, 0x0022, 0x8063, 0x0066, 0x006c, 0x8069, 0x0078, 0x807d, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805f, 0x005a, 0x804b, 0x004e, 0x0044, 0x8041, 0x80c3, 0x00c6, 0x00cc, 0x80c9,
+    0x00d8, 0x80dd, 0x80d7, 0x00d2, 0x00f0, 0x80f5, 0x80ff, 0x00fa, 0x80eb, 0x00ee, 0x00e4, 0x80e1,
+    0x00a0, 0x80a5, 0x80af, 0x00aa, 0x80bb, 0x00be, 0x00b4, 0x80b1, 0x8093, 0x0096, 0x009c, 0x8099,
+    0x0088, 0x808d, 0x8087, 0x0082, 0x8183, 0x0186, 0x018c, 0x8189, 0x0198, 0x819d, 0x8197, 0x0192,
+    0x01b0, 0x81b5, 0x81bf, 0x01ba, 0x81ab, 0x01ae, 0x01a4, 0x81a1, 0x01e0, 0x81e5, 0x81ef, 0x01ea,
+    0x81fb, 0x01fe, 0x01f4, 0x81f1, 0x81d3, 0x01d6, 0x01dc, 0x81d9, 0x01c8, 0x81cd, 0x81c7, 0x01c2,
+    0x0140, 0x8145, 0x814f, 0x014a, 0x815b, 0x015e, 0x0154, 0x8151, 0x8173, 0x0176, 0x017c, 0x8179,
+    0x0168, 0x816d, 0x8167, 0x0162, 0x8123, 0x0126, 0x012c, 0x8129, 0x0138, 0x813d, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811f, 0x011a, 0x810b, 0x010e, 0x0104, 0x8101, 0x8303, 0x0306, 0x030c, 0x8309,
+    0x0318, 0x831d, 0x8317, 0x0312, 0x0330, 0x8335, 0x833f, 0x033a, 0x832b, 0x032e, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836f, 0x036a, 0x837b, 0x037e, 0x0374, 0x8371, 0x8353, 0x0356, 0x035c, 0x8359,
+    0x0348, 0x834d, 0x8347, 0x0342, 0x03c0, 0x83c5, 0x83cf, 0x03ca, 0x83db, 0x03de, 0x03d4, 0x83d1,
+    0x83f3, 0x03f6, 0x03fc, 0x83f9, 0x03e8, 0x83ed, 0x83e7, 0x03e2, 0x83a3, 0x03a6, 0x03ac, 0x83a9,
+    0x03b8, 0x83bd, 0x83b7, 0x03b2, 0x0390, 0x8395, 0x839f, 0x039a, 0x838b, 0x038e, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828f, 0x028a, 0x829b, 0x029e, 0x0294, 0x8291, 0x82b3, 0x02b6, 0x02bc, 0x82b9,
+    0x02a8, 0x82ad, 0x82a7, 0x02a2, 0x82e3, 0x02e6, 0x02ec, 0x82e9, 0x02f8, 0x82fd, 0x82f7, 0x02f2,
+    0x02d0, 0x82d5, 0x82df, 0x02da, 0x82cb, 0x02ce, 0x02c4, 0x82c1, 0x8243, 0x0246, 0x024c, 0x8249,
+    0x0258, 0x825d, 0x8257, 0x0252, 0x0270, 0x8275, 0x827f, 0x027a, 0x826b, 0x026e, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822f, 0x022a, 0x823b, 0x023e, 0x0234, 0x8231, 0x8213, 0x0216, 0x021c, 0x8219,
+    0x0208, 0x820d, 0x8207, 0x0202,
+};
+
+static uint16_t crc16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0;
+  for (size_t i = 0; i < length; ++i) {
+    crc = (crc << 8) ^ CRC16_TABLE[(crc >> 8) ^ data[i]];
+  }
+  return crc;
+}
+
+static uint64_t read_u64(const uint8_t *data) {
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+// Finds the offset of the next potential frame sync code (0xFFF8 or 0xFFF9)
+static size_t find_frame_sync(const uint8_t *buffer, size_t buffer_length) {
+  size_t offset = 0;
+  while ((offset + 1 < buffer_length) && !((buffer[offset] == 0xFF) && ((buffer[offset + 1] & 0xFE) == 0xF8))) {
+    ++offset;
+  }
+  return offset;
+}
+
+// Fully unrolled LPC restoration for a fixed order. Safe when the prediction fits in 32 bits.
+template<uint8_t ORDER>
+static void restore_lpc_narrow(const int32_t *coefficients, int8_t shift, uint32_t block_size, int32_t *samples) {
+  for (uint32_t i = ORDER; i < block_size; ++i) {
+    const int32_t *history = samples + i - ORDER;
+    int32_t prediction = 0;
+    for (uint8_t j = 0; j < ORDER; ++j) {
+      prediction += coefficients[ORDER - 1 - j] * history[j];
+    }
+    samples[i] += prediction >> shift;
+  }
+}
+
+FLACStreamDecoder::~FLACStreamDecoder() { this->free_buffers_(); }
+
+FLACDecoderResult FLACStreamDecoder::read_header(const uint8_t *buffer, size_t buffer_length,
+                                                 size_t &bytes_consumed) {
+  bytes_consumed = 0;
+
+  while (true) {
+    // Skip an ID3v2 tag or an unwanted metadata block as it passes through; it never has to fit in the buffer
+    if (this->header_bytes_to_skip_ > 0) {
+      size_t bytes_to_skip = std::min(this->header_bytes_to_skip_, buffer_length - bytes_consumed);
+      bytes_consumed += bytes_to_skip;
+      this->header_bytes_to_skip_ -= bytes_to_skip;
+      if (this->header_bytes_to_skip_ > 0) {
+        return FLACDecoderResult::HEADER_OUT_OF_DATA;
+      }
+    }
+
+    const uint8_t *current = buffer + bytes_consumed;
+    size_t remaining = buffer_length - bytes_consumed;
+
+    switch (this->header_state_) {
+      case FLACHeaderState::MAGIC_NUMBER: {
+        if (remaining < ID3V2_HEADER_LENGTH) {
+          return FLACDecoderResult::HEADER_OUT_OF_DATA;
+        }
+
+        if ((current[0] == 'I') && (current[1] == 'D') && (current[2] == '3')) {
+          // The tag size is stored as a 28 bit syncsafe integer
+          size_t tag_size = ((current[6] & 0x7F) << 21) | ((current[7] & 0x7F) << 14) |
+                            ((current[8] & 0x7F) << 7) | (current[9] & 0x7F);
+          this->header_bytes_to_skip_ = ID3V2_HEADER_LENGTH + tag_size;
+          break;
+        }
+
+        if ((current[0] != 'f') || (current[1] != 'L') || (current[2] != 'a') || (current[3] != 'C')) {
+          return FLACDecoderResult::ERROR_BAD_MAGIC_NUMBER;
+        }
+        bytes_consumed += 4;
+        this->header_state_ = FLACHeaderState::BLOCK_HEADER;
+        break;
+      }
+      case FLACHeaderState::BLOCK_HEADER: {
+        if (this->last_metadata_block_) {
+          if (!this->has_stream_info_ || (this->max_block_size_ < 16) || (this->sample_rate_ == 0)) {
+            return FLACDecoderResult::ERROR_BAD_HEADER;
+          }
+
+          if (!this->allocate_buffers_()) {
+            return FLACDecoderResult::ERROR_MEMORY_ALLOCATION;
+          }
+
+          this->header_state_ = FLACHeaderState::FINISHED;
+          return FLACDecoderResult::SUCCESS;
+        }
+
+        if (remaining < METADATA_BLOCK_HEADER_LENGTH) {
+          return FLACDecoderResult::HEADER_OUT_OF_DATA;
+        }
+
+        this->last_metadata_block_ = current[0] & 0x80;
+        uint8_t block_type = current[0] & 0x7F;
+        this->metadata_block_bytes_left_ = (current[1] << 16) | (current[2] << 8) | current[3];
+        bytes_consumed += METADATA_BLOCK_HEADER_LENGTH;
+
+        if (block_type == STREAMINFO_BLOCK_TYPE) {
+          if (this->metadata_block_bytes_left_ < STREAMINFO_BLOCK_LENGTH) {
+            return FLACDecoderResult::ERROR_BAD_HEADER;
+          }
+          this->header_state_ = FLACHeaderState::STREAMINFO;
+        } else if (block_type == SEEKTABLE_BLOCK_TYPE) {
+          this->header_state_ = FLACHeaderState::SEEKTABLE;
+        } else {
+          // PADDING, PICTURE, VORBIS_COMMENT, and the rest aren't needed for playback
+          this->header_bytes_to_skip_ = this->metadata_block_bytes_left_;
+          this->metadata_block_bytes_left_ = 0;
+        }
+        break;
+      }
+      case FLACHeaderState::STREAMINFO: {
+        if (remaining < STREAMINFO_BLOCK_LENGTH) {
+          return FLACDecoderResult::HEADER_OUT_OF_DATA;
+        }
+
+        this->min_block_size_ = (current[0] << 8) | current[1];
+        this->max_block_size_ = (current[2] << 8) | current[3];
+        this->sample_rate_ = (current[10] << 12) | (current[11] << 4) | (current[12] >> 4);
+        this->num_channels_ = ((current[12] >> 1) & 0x07) + 1;
+        this->sample_depth_ = (((current[12] & 0x01) << 4) | (current[13] >> 4)) + 1;
+        this->total_samples_ = (static_cast<uint64_t>(current[13] & 0x0F) << 32) |
+                               (static_cast<uint32_t>(current[14]) << 24) | (current[15] << 16) |
+                               (current[16] << 8) | current[17];
+        this->has_stream_info_ = true;
+
+        // Skip the MD5 signature
+        bytes_consumed += STREAMINFO_BLOCK_LENGTH;
+        this->header_bytes_to_skip_ = this->metadata_block_bytes_left_ - STREAMINFO_BLOCK_LENGTH;
+        this->metadata_block_bytes_left_ = 0;
+        this->header_state_ = FLACHeaderState::BLOCK_HEADER;
+        break;
+      }
+      case FLACHeaderState::SEEKTABLE: {
+        // Read one seek point at a time, so a large table doesn't have to fit in the buffer
+        while ((this->metadata_block_bytes_left_ >= SEEK_POINT_LENGTH) && (remaining >= SEEK_POINT_LENGTH)) {
+          uint64_t sample_number = read_u64(current);
+          if ((sample_number != PLACEHOLDER_SEEK_POINT) && (this->seek_points_.size() < MAX_SEEK_POINTS)) {
+            FLACSeekPoint seek_point;
+            seek_point.sample_number = sample_number;
+            seek_point.stream_offset = read_u64(current + 8);
+            seek_point.frame_samples = (current[16] << 8) | current[17];
+            this->seek_points_.push_back(seek_point);
+          }
+
+          current += SEEK_POINT_LENGTH;
+          remaining -= SEEK_POINT_LENGTH;
+          bytes_consumed += SEEK_POINT_LENGTH;
+          this->metadata_block_bytes_left_ -= SEEK_POINT_LENGTH;
+        }
+
+        if (this->metadata_block_bytes_left_ >= SEEK_POINT_LENGTH) {
+          return FLACDecoderResult::HEADER_OUT_OF_DATA;
+        }
+
+        // Ignore a malformed partial seek point at the end of the block
+        this->header_bytes_to_skip_ = this->metadata_block_bytes_left_;
+        this->metadata_block_bytes_left_ = 0;
+        this->header_state_ = FLACHeaderState::BLOCK_HEADER;
+        break;
+      }
+      case FLACHeaderState::FINISHED:
+        return FLACDecoderResult::SUCCESS;
+    }
+  }
+}
+
+FLACDecoderResult FLACStreamDecoder::decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                                  size_t &samples_decoded, size_t &bytes_consumed) {
+  samples_decoded = 0;
+  bytes_consumed = 0;
+
+  size_t offset = find_frame_sync(buffer, buffer_length);
+  if (offset + 1 >= buffer_length) {
+    // Keep the last byte, it may be the start of a sync code
+    bytes_consumed = offset;
+    if (offset > 0) {
+      return FLACDecoderResult::ERROR_SYNC_NOT_FOUND;
+    }
+    return FLACDecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  const uint8_t *frame_start = buffer + offset;
+
+  FLACFrameHeader header;
+  FLACDecoderResult header_result = this->read_frame_header_(frame_start, buffer_length - offset, header);
+  if (header_result == FLACDecoderResult::ERROR_OUT_OF_DATA) {
+    bytes_consumed = offset;
+    return header_result;
+  } else if (header_result != FLACDecoderResult::SUCCESS) {
+    // Likely a false sync code; skip past it and look for the next one
+    bytes_consumed = offset + 1;
+    return header_result;
+  }
+
+  this->read_current_ = frame_start + header.length;
+  this->read_end_ = buffer + buffer_length;
+  this->cache_ = 0;
+  this->cache_bits_ = 0;
+  this->out_of_data_ = false;
+
+  uint32_t block_size = header.block_size;
+  uint8_t channel_assignment = header.channel_assignment;
+  uint8_t sample_depth = header.sample_depth;
+  uint8_t channels = this->num_channels_;
+
+  for (uint8_t channel = 0; channel < channels; ++channel) {
+    uint8_t subframe_depth = sample_depth;
+    if (((channel_assignment == CHANNEL_ASSIGNMENT_LEFT_SIDE) && (channel == 1)) ||
+        ((channel_assignment == CHANNEL_ASSIGNMENT_SIDE_RIGHT) && (channel == 0)) ||
+        ((channel_assignment == CHANNEL_ASSIGNMENT_MID_SIDE) && (channel == 1))) {
+      ++subframe_depth;
+    }
+
+    FLACDecoderResult result = this->decode_subframe_(block_size, subframe_depth,
+                                                      this->channel_buffers_ + channel * this->max_block_size_);
+    if (result == FLACDecoderResult::ERROR_OUT_OF_DATA) {
+      bytes_consumed = offset;
+      return result;
+    } else if (result != FLACDecoderResult::SUCCESS) {
+      bytes_consumed = offset + 1;
+      return result;
+    }
+  }
+
+  // Zero padding to the byte boundary and the frame's CRC-16, which covers everything from the sync code on
+  this->align_to_byte_();
+  const uint8_t *frame_crc_start = this->read_current_ - this->cache_bits_ / 8;
+  uint16_t frame_crc = this->read_uint_(16);
+
+  if (this->out_of_data_) {
+    bytes_consumed = offset;
+    return FLACDecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  if (crc16(frame_start, frame_crc_start - frame_start) != frame_crc) {
+    bytes_consumed = offset + 1;
+    return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+  }
+
+  this->write_output_(channel_assignment, block_size, sample_depth, output_buffer);
+
+  samples_decoded = block_size * channels;
+  bytes_consumed = (this->read_current_ - buffer) - this->cache_bits_ / 8;
+
+  // The frame's position comes from its header, so frames can be decoded out of order by separate decoders
+  uint64_t first_sample = header.number;
+  if (!header.variable_block_size) {
+    // Fixed block size streams number their frames; every frame except the last has the same size
+    first_sample *= (this->min_block_size_ == this->max_block_size_) ? this->max_block_size_ : block_size;
+  }
+
+  if ((this->total_samples_ > 0) && (first_sample + block_size >= this->total_samples_)) {
+    return FLACDecoderResult::NO_MORE_FRAMES;
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+FLACDecoderResult FLACStreamDecoder::copy_header(const FLACStreamDecoder &source) {
+  this->sample_rate_ = source.sample_rate_;
+  this->num_channels_ = source.num_channels_;
+  this->sample_depth_ = source.sample_depth_;
+  this->min_block_size_ = source.min_block_size_;
+  this->max_block_size_ = source.max_block_size_;
+  this->total_samples_ = source.total_samples_;
+
+  if (!this->allocate_buffers_()) {
+    return FLACDecoderResult::ERROR_MEMORY_ALLOCATION;
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+bool FLACStreamDecoder::find_next_frame(const uint8_t *buffer, size_t buffer_length, size_t &next_frame_offset) const {
+  FLACFrameHeader header;
+  if ((buffer_length < 2) || (buffer[0] != 0xFF) || ((buffer[1] & 0xFE) != 0xF8) ||
+      (this->read_frame_header_(buffer, buffer_length, header) != FLACDecoderResult::SUCCESS)) {
+    return false;
+  }
+
+  // A false sync code inside the audio data also has to pass the header CRC and continue the numbering
+  uint64_t expected_number = header.variable_block_size ? header.number + header.block_size : header.number + 1;
+  uint8_t expected_sync_byte = buffer[1];  // The blocking strategy never changes within a stream
+
+  // Every subframe has at least a one byte header, and the frame ends with a CRC-16
+  size_t position = header.length + this->num_channels_ + 2;
+  while (position + 1 < buffer_length) {
+    const uint8_t *candidate =
+        static_cast<const uint8_t *>(memchr(buffer + position, 0xFF, buffer_length - position - 1));
+    if (candidate == nullptr) {
+      return false;
+    }
+    position = candidate - buffer;
+
+    if (candidate[1] == expected_sync_byte) {
+      FLACFrameHeader next_header;
+      FLACDecoderResult result = this->read_frame_header_(candidate, buffer_length - position, next_header);
+      if (result == FLACDecoderResult::ERROR_OUT_OF_DATA) {
+        return false;
+      }
+      if ((result == FLACDecoderResult::SUCCESS) && (next_header.number == expected_number)) {
+        next_frame_offset = position;
+        return true;
+      }
+    }
+    ++position;
+  }
+
+  return false;
+}
+
+FLACDecoderResult FLACStreamDecoder::read_frame_header_(const uint8_t *buffer, size_t buffer_length,
+                                                        FLACFrameHeader &header) const {
+  // Sync code, the block size and sample rate codes, the channel and sample size codes, and the first number byte
+  if (buffer_length < 5) {
+    return FLACDecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  // The sync code and reserved bit were checked by the caller's sync search
+  header.variable_block_size = buffer[1] & 0x01;
+  uint8_t block_size_code = buffer[2] >> 4;
+  uint8_t sample_rate_code = buffer[2] & 0x0F;
+  header.channel_assignment = buffer[3] >> 4;
+  uint8_t sample_size_code = (buffer[3] >> 1) & 0x07;
+
+  if ((block_size_code == 0) || (sample_rate_code == 15) || (header.channel_assignment > CHANNEL_ASSIGNMENT_MID_SIDE) ||
+      (sample_size_code == 3) || (buffer[3] & 0x01)) {
+    return FLACDecoderResult::ERROR_BAD_HEADER;
+  }
+
+  // Frame or sample number, coded like UTF-8 (up to 7 bytes)
+  size_t position = 4;
+  uint8_t first_byte = buffer[position++];
+  uint8_t extra_bytes = 0;
+  uint64_t number = first_byte;
+  if (first_byte & 0x80) {
+    while ((extra_bytes < 7) && (first_byte & (0x40 >> extra_bytes))) {
+      ++extra_bytes;
+    }
+    if ((extra_bytes == 0) || (extra_bytes == 7)) {
+      return FLACDecoderResult::ERROR_BAD_HEADER;
+    }
+    number = first_byte & (0x3F >> extra_bytes);
+  }
+
+  // Remaining number bytes, the optional block size and sample rate fields, and the CRC-8
+  size_t remaining_length = extra_bytes + 1;
+  if ((block_size_code == 6) || (sample_rate_code == 12)) {
+    ++remaining_length;
+  }
+  if (block_size_code == 7) {
+    remaining_length += 2;
+  }
+  if ((sample_rate_code == 13) || (sample_rate_code == 14)) {
+    remaining_length += 2;
+  }
+  if (position + remaining_length > buffer_length) {
+    return FLACDecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  for (uint8_t i = 0; i < extra_bytes; ++i) {
+    uint8_t byte = buffer[position++];
+    if ((byte & 0xC0) != 0x80) {
+      return FLACDecoderResult::ERROR_BAD_HEADER;
+    }
+    number = (number << 6) | (byte & 0x3F);
+  }
+  header.number = number;
+
+  if (block_size_code == 1) {
+    header.block_size = 192;
+  } else if (block_size_code <= 5) {
+    header.block_size = 576 << (block_size_code - 2);
+  } else if (block_size_code == 6) {
+    header.block_size = buffer[position] + 1;
+    position += 1;
+  } else if (block_size_code == 7) {
+    header.block_size = ((buffer[position] << 8) | buffer[position + 1]) + 1;
+    position += 2;
+  } else {
+    header.block_size = 256 << (block_size_code - 8);
+  }
+
+  if (sample_rate_code == 12) {
+    position += 1;
+  } else if ((sample_rate_code == 13) || (sample_rate_code == 14)) {
+    position += 2;
+  }
+
+  uint8_t channels = (header.channel_assignment < CHANNEL_ASSIGNMENT_LEFT_SIDE) ? header.channel_assignment + 1 : 2;
+  header.sample_depth = (sample_size_code == 0) ? this->sample_depth_ : SAMPLE_SIZE_TABLE[sample_size_code];
+  header.length = position + 1;
+
+  if ((header.block_size > this->max_block_size_) || (channels != this->num_channels_) ||
+      (crc8(buffer, position) != buffer[position])) {
+    return FLACDecoderResult::ERROR_BAD_HEADER;
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+bool FLACStreamDecoder::allocate_buffers_() {
+  size_t buffers_size = this->max_block_size_ * this->num_channels_;
+  if ((this->channel_buffers_ != nullptr) && (this->channel_buffers_size_ >= buffers_size)) {
+    return true;
+  }
+
+  this->free_buffers_();
+
+  ExternalRAMAllocator<int32_t> allocator(ExternalRAMAllocator<int32_t>::ALLOW_FAILURE);
+  this->channel_buffers_ = allocator.allocate(buffers_size);
+  if (this->channel_buffers_ == nullptr) {
+    return false;
+  }
+  this->channel_buffers_size_ = buffers_size;
+
+  return true;
+}
+
+void FLACStreamDecoder::free_buffers_() {
+  if (this->channel_buffers_ != nullptr) {
+    ExternalRAMAllocator<int32_t> allocator(ExternalRAMAllocator<int32_t>::ALLOW_FAILURE);
+    allocator.deallocate(this->channel_buffers_, this->channel_buffers_size_);
+    this->channel_buffers_ = nullptr;
+    this->channel_buffers_size_ = 0;
+  }
+}
+
+void FLACStreamDecoder::refill_() {
+  while (this->cache_bits_ <= 32) {
+    if (this->read_end_ - this->read_current_ >= 4) {
+      // Load a whole big-endian word at once
+      uint32_t word = (static_cast<uint32_t>(this->read_current_[0]) << 24) |
+                      (static_cast<uint32_t>(this->read_current_[1]) << 16) |
+                      (static_cast<uint32_t>(this->read_current_[2]) << 8) | this->read_current_[3];
+      this->cache_ |= static_cast<uint64_t>(word) << (32 - this->cache_bits_);
+      this->read_current_ += 4;
+      this->cache_bits_ += 32;
+    } else if (this->read_current_ < this->read_end_) {
+      this->cache_ |= static_cast<uint64_t>(*this->read_current_) << (56 - this->cache_bits_);
+      ++this->read_current_;
+      this->cache_bits_ += 8;
+    } else {
+      return;
+    }
+  }
+}
+
+uint32_t FLACStreamDecoder::read_uint_(uint8_t num_bits) {
+  if (num_bits == 0) {
+    return 0;
+  }
+
+  if (this->cache_bits_ < num_bits) {
+    this->refill_();
+    if (this->cache_bits_ < num_bits) {
+      this->out_of_data_ = true;
+      this->cache_ = 0;
+      this->cache_bits_ = 0;
+      return 0;
+    }
+  }
+
+  uint32_t value = static_cast<uint32_t>(this->cache_ >> (64 - num_bits));
+  this->cache_ <<= num_bits;
+  this->cache_bits_ -= num_bits;
+
+  return value;
+}
+
+int32_t FLACStreamDecoder::read_sint_(uint8_t num_bits) {
+  if (num_bits == 0) {
+    return 0;
+  }
+  uint32_t value = this->read_uint_(num_bits);
+  // Sign extend
+  return static_cast<int32_t>(value << (32 - num_bits)) >> (32 - num_bits);
+}
+
+uint32_t FLACStreamDecoder::read_unary_() {
+  uint32_t zeros = 0;
+  while (true) {
+    if (this->cache_ != 0) {
+      uint8_t leading_zeros = __builtin_clzll(this->cache_);
+      zeros += leading_zeros;
+      this->cache_ <<= leading_zeros;
+      this->cache_ <<= 1;
+      this->cache_bits_ -= leading_zeros + 1;
+      return zeros;
+    }
+
+    zeros += this->cache_bits_;
+    this->cache_bits_ = 0;
+    this->refill_();
+    if (this->cache_bits_ == 0) {
+      this->out_of_data_ = true;
+      return zeros;
+    }
+  }
+}
+
+void FLACStreamDecoder::align_to_byte_() {
+  uint8_t padding_bits = this->cache_bits_ % 8;
+  this->cache_ <<= padding_bits;
+  this->cache_bits_ -= padding_bits;
+}
+
+FLACDecoderResult FLACStreamDecoder::decode_subframe_(uint32_t block_size, uint8_t sample_depth, int32_t *samples) {
+  bool padding_bit = this->read_uint_(1);
+  uint8_t subframe_type = this->read_uint_(6);
+
+  uint8_t wasted_bits = 0;
+  if (this->read_uint_(1)) {
+    wasted_bits = this->read_unary_() + 1;
+    if (wasted_bits >= sample_depth) {
+      return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+    }
+    sample_depth -= wasted_bits;
+  }
+
+  if (padding_bit) {
+    return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+  }
+
+  if (sample_depth > 32) {
+    return FLACDecoderResult::ERROR_UNSUPPORTED;
+  }
+
+  if (subframe_type == SUBFRAME_TYPE_CONSTANT) {
+    int32_t value = this->read_sint_(sample_depth);
+    for (uint32_t i = 0; i < block_size; ++i) {
+      samples[i] = value;
+    }
+  } else if (subframe_type == SUBFRAME_TYPE_VERBATIM) {
+    for (uint32_t i = 0; i < block_size; ++i) {
+      samples[i] = this->read_sint_(sample_depth);
+    }
+  } else if ((subframe_type >= SUBFRAME_TYPE_FIXED_MIN) && (subframe_type <= SUBFRAME_TYPE_FIXED_MAX)) {
+    uint8_t order = subframe_type - SUBFRAME_TYPE_FIXED_MIN;
+    if (order > block_size) {
+      return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+    }
+
+    for (uint8_t i = 0; i < order; ++i) {
+      samples[i] = this->read_sint_(sample_depth);
+    }
+
+    FLACDecoderResult result = this->decode_residual_(block_size, order, samples);
+    if (result != FLACDecoderResult::SUCCESS) {
+      return result;
+    }
+
+    this->restore_fixed_(order, block_size, samples);
+  } else if (subframe_type >= SUBFRAME_TYPE_LPC_MIN) {
+    uint8_t order = (subframe_type & 0x1F) + 1;
+    if (order > block_size) {
+      return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+    }
+
+    for (uint8_t i = 0; i < order; ++i) {
+      samples[i] = this->read_sint_(sample_depth);
+    }
+
+    uint8_t precision = this->read_uint_(4) + 1;
+    int8_t shift = this->read_sint_(5);
+    if ((precision == 16) || (shift < 0)) {
+      return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+    }
+
+    int32_t coefficients[MAX_LPC_ORDER];
+    for (uint8_t i = 0; i < order; ++i) {
+      coefficients[i] = this->read_sint_(precision);
+    }
+
+    FLACDecoderResult result = this->decode_residual_(block_size, order, samples);
+    if (result != FLACDecoderResult::SUCCESS) {
+      return result;
+    }
+
+    // The prediction fits in 32 bits if sample_depth + precision + ceil(log2(order)) <= 32
+    uint8_t order_bits = 0;
+    while ((1u << order_bits) < order) {
+      ++order_bits;
+    }
+    bool wide_accumulator = (sample_depth + precision + order_bits) > 32;
+
+    this->restore_lpc_(coefficients, order, shift, wide_accumulator, block_size, samples);
+  } else {
+    // Reserved subframe type
+    return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+  }
+
+  if (this->out_of_data_) {
+    return FLACDecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  if (wasted_bits > 0) {
+    for (uint32_t i = 0; i < block_size; ++i) {
+      samples[i] <<= wasted_bits;
+    }
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+FLACDecoderResult FLACStreamDecoder::decode_residual_(uint32_t block_size, uint8_t predictor_order, int32_t *samples) {
+  uint8_t coding_method = this->read_uint_(2);
+  if (coding_method > 1) {
+    return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+  }
+  uint8_t parameter_bits = (coding_method == 0) ? 4 : 5;
+  uint8_t escape_parameter = (coding_method == 0) ? 0x0F : 0x1F;
+
+  uint8_t partition_order = this->read_uint_(4);
+  uint32_t partition_count = 1 << partition_order;
+  uint32_t partition_samples = block_size >> partition_order;
+
+  if (((partition_samples << partition_order) != block_size) || (partition_samples < predictor_order)) {
+    return FLACDecoderResult::ERROR_CORRUPT_FRAME;
+  }
+
+  int32_t *residuals = samples + predictor_order;
+  for (uint32_t partition = 0; partition < partition_count; ++partition) {
+    uint32_t count = (partition == 0) ? partition_samples - predictor_order : partition_samples;
+    uint8_t rice_parameter = this->read_uint_(parameter_bits);
+
+    if (rice_parameter == escape_parameter) {
+      // Unencoded partition; each residual is stored with a fixed number of bits
+      uint8_t raw_bits = this->read_uint_(5);
+      for (uint32_t i = 0; i < count; ++i) {
+        residuals[i] = this->read_sint_(raw_bits);
+      }
+    } else {
+      FLACDecoderResult result = this->decode_rice_partition_(rice_parameter, count, residuals);
+      if (result != FLACDecoderResult::SUCCESS) {
+        return result;
+      }
+    }
+
+    if (this->out_of_data_) {
+      return FLACDecoderResult::ERROR_OUT_OF_DATA;
+    }
+
+    residuals += count;
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+FLACDecoderResult FLACStreamDecoder::decode_rice_partition_(uint8_t rice_parameter, uint32_t count,
+                                                            int32_t *residuals) {
+  for (uint32_t i = 0; i < count; ++i) {
+    if (this->cache_bits_ <= 32) {
+      this->refill_();
+    }
+
+    uint32_t folded;
+    uint8_t leading_zeros = (this->cache_ != 0) ? __builtin_clzll(this->cache_) : 64;
+
+    if (leading_zeros + 1 + rice_parameter <= this->cache_bits_) {
+      // Fast path: the whole code word is in the cache. The quotient is the number of leading zeros, and the
+      // remainder is the next ``rice_parameter`` bits after the stop bit.
+      uint64_t cache = (this->cache_ << leading_zeros) << 1;
+      uint32_t remainder = (rice_parameter > 0) ? static_cast<uint32_t>(cache >> (64 - rice_parameter)) : 0;
+      this->cache_ = cache << rice_parameter;
+      this->cache_bits_ -= leading_zeros + 1 + rice_parameter;
+      folded = (static_cast<uint32_t>(leading_zeros) << rice_parameter) | remainder;
+    } else {
+      // Slow path: a long quotient or the end of the buffer
+      uint32_t quotient = this->read_unary_();
+      uint32_t remainder = this->read_uint_(rice_parameter);
+      if (this->out_of_data_) {
+        return FLACDecoderResult::ERROR_OUT_OF_DATA;
+      }
+      folded = (quotient << rice_parameter) | remainder;
+    }
+
+    // Undo the zigzag folding of signed values
+    residuals[i] = static_cast<int32_t>(folded >> 1) ^ -static_cast<int32_t>(folded & 1);
+  }
+
+  return FLACDecoderResult::SUCCESS;
+}
+
+void FLACStreamDecoder::restore_fixed_(uint8_t order, uint32_t block_size, int32_t *samples) {
+  switch (order) {
+    case 1:
+      for (uint32_t i = 1; i < block_size; ++i) {
+        samples[i] += samples[i - 1];
+      }
+      break;
+    case 2:
+      for (uint32_t i = 2; i < block_size; ++i) {
+        samples[i] += 2 * samples[i - 1] - samples[i - 2];
+      }
+      break;
+    case 3:
+      for (uint32_t i = 3; i < block_size; ++i) {
+        samples[i] += 3 * (samples[i - 1] - samples[i - 2]) + samples[i - 3];
+      }
+      break;
+    case 4:
+      for (uint32_t i = 4; i < block_size; ++i) {
+        samples[i] += 4 * (samples[i - 1] + samples[i - 3]) - 6 * samples[i - 2] - samples[i - 4];
+      }
+      break;
+    default:
+      // Order 0; the residuals are the samples
+      break;
+  }
+}
+
+void FLACStreamDecoder::restore_lpc_(const int32_t *coefficients, uint8_t order, int8_t shift, bool wide_accumulator,
+                                     uint32_t block_size, int32_t *samples) {
+  if (!wide_accumulator) {
+    switch (order) {
+      case 1:
+        restore_lpc_narrow<1>(coefficients, shift, block_size, samples);
+        return;
+      case 2:
+        restore_lpc_narrow<2>(coefficients, shift, block_size, samples);
+        return;
+      case 3:
+        restore_lpc_narrow<3>(coefficients, shift, block_size, samples);
+        return;
+      case 4:
+        restore_lpc_narrow<4>(coefficients, shift, block_size, samples);
+        return;
+      case 5:
+        restore_lpc_narrow<5>(coefficients, shift, block_size, samples);
+        return;
+      case 6:
+        restore_lpc_narrow<6>(coefficients, shift, block_size, samples);
+        return;
+      case 7:
+        restore_lpc_narrow<7>(coefficients, shift, block_size, samples);
+        return;
+      case 8:
+        restore_lpc_narrow<8>(coefficients, shift, block_size, samples);
+        return;
+      case 9:
+        restore_lpc_narrow<9>(coefficients, shift, block_size, samples);
+        return;
+      case 10:
+        restore_lpc_narrow<10>(coefficients, shift, block_size, samples);
+        return;
+      case 11:
+        restore_lpc_narrow<11>(coefficients, shift, block_size, samples);
+        return;
+      case 12:
+        restore_lpc_narrow<12>(coefficients, shift, block_size, samples);
+        return;
+      default:
+        for (uint32_t i = order; i < block_size; ++i) {
+          int32_t prediction = 0;
+          for (uint8_t j = 0; j < order; ++j) {
+            prediction += coefficients[j] * samples[i - 1 - j];
+          }
+          samples[i] += prediction >> shift;
+        }
+        return;
+    }
+  }
+
+  // Large sample depths or high precision coefficients; accumulate in 64 bits to avoid overflow
+  for (uint32_t i = order; i < block_size; ++i) {
+    int64_t prediction = 0;
+    for (uint8_t j = 0; j < order; ++j) {
+      prediction += static_cast<int64_t>(coefficients[j]) * samples[i - 1 - j];
+    }
+    samples[i] += static_cast<int32_t>(prediction >> shift);
+  }
+}
+
+void FLACStreamDecoder::write_output_(uint8_t channel_assignment, uint32_t block_size, uint8_t sample_depth,
+                                      int16_t *output_buffer) {
+  // Deeper samples keep their 16 most significant bits; 8 and 12 bit samples are scaled up to full range
+  const uint8_t right_shift = (sample_depth > 16) ? sample_depth - 16 : 0;
+  const int32_t multiplier = (sample_depth < 16) ? 1 << (16 - sample_depth) : 1;
+  auto to_16_bit = [right_shift, multiplier](int32_t sample) -> int16_t {
+    return static_cast<int16_t>((sample >> right_shift) * multiplier);
+  };
+
+  const int32_t *first = this->channel_buffers_;
+  const int32_t *second = this->channel_buffers_ + this->max_block_size_;
+
+  switch (channel_assignment) {
+    case CHANNEL_ASSIGNMENT_LEFT_SIDE:
+      for (uint32_t i = 0; i < block_size; ++i) {
+        int32_t left = first[i];
+        output_buffer[2 * i] = to_16_bit(left);
+        output_buffer[2 * i + 1] = to_16_bit(left - second[i]);
+      }
+      break;
+    case CHANNEL_ASSIGNMENT_SIDE_RIGHT:
+      for (uint32_t i = 0; i < block_size; ++i) {
+        int32_t right = second[i];
+        output_buffer[2 * i] = to_16_bit(first[i] + right);
+        output_buffer[2 * i + 1] = to_16_bit(right);
+      }
+      break;
+    case CHANNEL_ASSIGNMENT_MID_SIDE:
+      for (uint32_t i = 0; i < block_size; ++i) {
+        int32_t side = second[i];
+        int32_t mid = (static_cast<uint32_t>(first[i]) << 1) | (side & 1);
+        output_buffer[2 * i] = to_16_bit((mid + side) >> 1);
+        output_buffer[2 * i + 1] = to_16_bit((mid - side) >> 1);
+      }
+      break;
+    default:
+      if (this->num_channels_ == 1) {
+        for (uint32_t i = 0; i < block_size; ++i) {
+          output_buffer[i] = to_16_bit(first[i]);
+        }
+      } else {
+        // Independent channels
+        for (uint8_t channel = 0; channel < this->num_channels_; ++channel) {
+          const int32_t *channel_samples = this->channel_buffers_ + channel * this->max_block_size_;
+          int16_t *output = output_buffer + channel;
+          for (uint32_t i = 0; i < block_size; ++i) {
+            *output = to_16_bit(channel_samples[i]);
+            output += this->num_channels_;
+          }
+        }
+      }
+      break;
+  }
+}
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
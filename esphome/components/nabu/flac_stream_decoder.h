@@ -0,0 +1,163 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace nabu {
+
+// Optimized FLAC decoder used by the ``AudioDecoder``
+//  - Reads the stream header incrementally; unneeded metadata (PICTURE, PADDING, etc.) is skipped as it streams
+//    through, so the input buffer only has to fit audio frames. STREAMINFO and the SEEKTABLE are kept.
+//  - Decodes one frame at a time from a linear input buffer
+//  - The bit reader keeps a 64 bit cache that is refilled a 32 bit word at a time
+//  - Rice coded residuals are decoded with a count-leading-zeros instruction for the unary part; the common
+//    partition path avoids per-bit branching entirely. A leading-zeros lookup table was measured slower on the host,
+//    and the ESP32-S3 counts leading zeros with its NSAU instruction, so no table is used.
+//  - LPC restoration is specialized (fully unrolled) for each predictor order up to 12 and uses 32 bit accumulation
+//    whenever the coefficient precision and sample depth guarantee it cannot overflow
+//  - Stereo decorrelation is fused with interleaving into the 16 bit output buffer; samples of any depth are scaled
+//    to 16 bits
+//  - Each frame's CRC-16 is verified before its samples are written, so a corrupt frame is skipped instead of played
+
+enum class FLACDecoderResult : uint8_t {
+  SUCCESS = 0,
+  NO_MORE_FRAMES,          // Decoded the final frame of the stream
+  HEADER_OUT_OF_DATA,      // The header isn't complete; try again with more data
+  ERROR_OUT_OF_DATA,       // The frame isn't complete; try again with more data
+  ERROR_BAD_MAGIC_NUMBER,  // Anything with a greater value is a corrupt frame or unsupported stream
+  ERROR_BAD_HEADER,
+  ERROR_SYNC_NOT_FOUND,
+  ERROR_UNSUPPORTED,
+  ERROR_CORRUPT_FRAME,
+  ERROR_MEMORY_ALLOCATION,
+};
+
+enum class FLACHeaderState : uint8_t {
+  MAGIC_NUMBER = 0,
+  BLOCK_HEADER,
+  STREAMINFO,
+  SEEKTABLE,
+  FINISHED,
+};
+
+struct FLACSeekPoint {
+  uint64_t sample_number;  // First sample of the target frame
+  uint64_t stream_offset;  // Offset of the target frame from the first frame's header
+  uint16_t frame_samples;
+};
+
+struct FLACFrameHeader {
+  uint64_t number;  // Frame number for fixed block size streams; first sample number otherwise
+  uint32_t block_size;
+  uint8_t channel_assignment;
+  uint8_t sample_depth;
+  uint8_t length;  // Header bytes, including the CRC-8
+  bool variable_block_size;
+};
+
+class FLACStreamDecoder {
+ public:
+  ~FLACStreamDecoder();
+
+  /// @brief Reads the FLAC stream header and its metadata blocks. Call repeatedly with the unconsumed data until it
+  /// returns SUCCESS; metadata blocks don't need to fit in the buffer.
+  /// @param buffer Input data continuing where the previous call stopped
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param bytes_consumed Set to the number of bytes used, even if more data is needed
+  /// @return SUCCESS if the header was read, HEADER_OUT_OF_DATA if more data is needed, or an error
+  FLACDecoderResult read_header(const uint8_t *buffer, size_t buffer_length, size_t &bytes_consumed);
+
+  /// @brief Decodes a single frame into interleaved 16 bit samples
+  /// @param buffer Input data, ideally starting at a frame's sync code
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param output_buffer Buffer for the decoded samples. Must hold at least `get_output_buffer_size()` samples.
+  /// @param samples_decoded Set to the number of samples (summed over all channels) decoded
+  /// @param bytes_consumed Set to the number of bytes used; on errors this skips to the next potential frame
+  /// @return SUCCESS or NO_MORE_FRAMES if a frame was decoded, ERROR_OUT_OF_DATA if the frame is incomplete, or an
+  /// error if the frame is corrupt
+  FLACDecoderResult decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                 size_t &samples_decoded, size_t &bytes_consumed);
+
+  /// @brief Takes the stream information from a decoder that already read the header, so another decoder can decode
+  /// frames of the same stream independently
+  /// @param source Decoder that successfully read the stream header
+  /// @return SUCCESS or ERROR_MEMORY_ALLOCATION
+  FLACDecoderResult copy_header(const FLACStreamDecoder &source);
+
+  /// @brief Finds where the frame following the one at the start of the buffer begins without decoding either
+  /// @param buffer Input data starting at a frame's sync code
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param next_frame_offset Set to the offset of the following frame's sync code if found
+  /// @return true if the following frame's header is in the buffer and continues the first frame's numbering
+  bool find_next_frame(const uint8_t *buffer, size_t buffer_length, size_t &next_frame_offset) const;
+
+  /// @brief Seek points from the SEEKTABLE metadata block, excluding placeholders; empty if the stream has none
+  const std::vector<FLACSeekPoint> &get_seek_points() const { return this->seek_points_; }
+
+  uint32_t get_sample_rate() const { return this->sample_rate_; }
+  uint8_t get_num_channels() const { return this->num_channels_; }
+  /// @brief Sample depth of the stream. Decoded samples are always scaled to 16 bits.
+  uint8_t get_sample_depth() const { return this->sample_depth_; }
+  uint64_t get_total_samples() const { return this->total_samples_; }
+
+  /// @brief Minimum size of the output buffer passed to `decode_frame`
+  /// @return Number of int16_t samples
+  size_t get_output_buffer_size() const { return this->max_block_size_ * this->num_channels_; }
+
+ protected:
+  /// @brief Parses a frame header that starts with a sync code; doesn't touch the bit reader
+  FLACDecoderResult read_frame_header_(const uint8_t *buffer, size_t buffer_length, FLACFrameHeader &header) const;
+
+  /// @brief Allocates the per channel working buffers based on the STREAMINFO block
+  bool allocate_buffers_();
+  void free_buffers_();
+
+  // Bit reader functions. The cache is left aligned; bits past `cache_bits_` are always zero.
+  void refill_();
+  uint32_t read_uint_(uint8_t num_bits);
+  int32_t read_sint_(uint8_t num_bits);
+  uint32_t read_unary_();
+  void align_to_byte_();
+
+  FLACDecoderResult decode_subframe_(uint32_t block_size, uint8_t sample_depth, int32_t *samples);
+  FLACDecoderResult decode_residual_(uint32_t block_size, uint8_t predictor_order, int32_t *samples);
+  FLACDecoderResult decode_rice_partition_(uint8_t rice_parameter, uint32_t count, int32_t *residuals);
+
+  void restore_fixed_(uint8_t order, uint32_t block_size, int32_t *samples);
+  void restore_lpc_(const int32_t *coefficients, uint8_t order, int8_t shift, bool wide_accumulator,
+                    uint32_t block_size, int32_t *samples);
+
+  void write_output_(uint8_t channel_assignment, uint32_t block_size, uint8_t sample_depth, int16_t *output_buffer);
+
+  const uint8_t *read_current_{nullptr};
+  const uint8_t *read_end_{nullptr};
+  uint64_t cache_{0};
+  uint8_t cache_bits_{0};
+  bool out_of_data_{false};
+
+  FLACHeaderState header_state_{FLACHeaderState::MAGIC_NUMBER};
+  size_t header_bytes_to_skip_{0};
+  uint32_t metadata_block_bytes_left_{0};
+  bool last_metadata_block_{false};
+  bool has_stream_info_{false};
+  std::vector<FLACSeekPoint> seek_points_;
+
+  int32_t *channel_buffers_{nullptr};
+  size_t channel_buffers_size_{0};
+
+  uint32_t sample_rate_{0};
+  uint8_t num_channels_{0};
+  uint8_t sample_depth_{0};
+  uint32_t min_block_size_{0};
+  uint32_t max_block_size_{0};
+  uint64_t total_samples_{0};  // Per channel; 0 if unknown
+};
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
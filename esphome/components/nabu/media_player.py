@@ -6,7 +6,7 @@ from pathlib import Path
 
 from esphome import automation, external_files
 import esphome.codegen as cg
-from esphome.components import audio_dac, media_player, speaker
+from esphome.components import asset_partition, audio_dac, media_player, speaker
 from esphome.components.media_player import MEDIA_FILE_TYPE_ENUM, MediaFile
 import esphome.config_validation as cv
 from esphome.const import (
@@ -24,6 +24,8 @@ from esphome.const import (
 from esphome.core import CORE, HexInt
 from esphome.external_files import download_content
 
+from . import qoa
+
 _LOGGER = logging.getLogger(__name__)
 
 AUTO_LOAD = ["audio"]
@@ -35,11 +37,18 @@ DOMAIN = "file"
 TYPE_LOCAL = "local"
 TYPE_WEB = "web"
 
+TRANSCODE_QOA = "qoa"
+
 CONF_DECIBEL_REDUCTION = "decibel_reduction"
 
 CONF_AUDIO_DAC = "audio_dac"
 CONF_ANNOUNCEMENT = "announcement"
 CONF_MEDIA_FILE = "media_file"
+CONF_MIXER_BLOCK_DURATION = "mixer_block_duration"
+CONF_MAX_OUTPUT_WAKE_LATENCY = "max_output_wake_latency"
+CONF_OUTPUT_STANDBY_TIMEOUT = "output_standby_timeout"
+CONF_PARALLEL_FLAC_DECODING = "parallel_flac_decoding"
+CONF_TRANSCODE = "transcode"
 CONF_VOLUME_INCREMENT = "volume_increment"
 CONF_VOLUME_MIN = "volume_min"
 CONF_VOLUME_MAX = "volume_max"
@@ -47,6 +56,8 @@ CONF_VOLUME_MAX = "volume_max"
 CONF_ON_MUTE = "on_mute"
 CONF_ON_UNMUTE = "on_unmute"
 CONF_ON_VOLUME = "on_volume"
+CONF_ON_OUTPUT_STANDBY = "on_output_standby"
+CONF_ON_OUTPUT_WAKE = "on_output_wake"
 
 nabu_ns = cg.esphome_ns.namespace("nabu")
 NabuMediaPlayer = nabu_ns.class_("NabuMediaPlayer")
@@ -141,6 +152,7 @@ MEDIA_FILE_TYPE_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_ID): cv.declare_id(MediaFile),
         cv.Required(CONF_FILE): _file_schema,
+        cv.Optional(CONF_TRANSCODE): cv.one_of(TRANSCODE_QOA, lower=True),
         cv.GenerateID(CONF_RAW_DATA_ID): cv.declare_id(cg.uint8),
     }
 )
@@ -152,6 +164,17 @@ CONFIG_SCHEMA = media_player.MEDIA_PLAYER_SCHEMA.extend(
         cv.Required(CONF_SPEAKER): cv.use_id(speaker.Speaker),
         cv.Optional(CONF_AUDIO_DAC): cv.use_id(audio_dac.AudioDac),
         cv.Optional(CONF_SAMPLE_RATE, default=16000): cv.int_range(min=1),
+        cv.Optional(CONF_MIXER_BLOCK_DURATION): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(
+                min=cv.TimePeriod(milliseconds=2), max=cv.TimePeriod(milliseconds=100)
+            ),
+        ),
+        cv.Optional(CONF_PARALLEL_FLAC_DECODING, default=False): cv.boolean,
+        cv.Optional(CONF_OUTPUT_STANDBY_TIMEOUT): cv.positive_not_null_time_period,
+        cv.Optional(
+            CONF_MAX_OUTPUT_WAKE_LATENCY, default="100ms"
+        ): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_VOLUME_INCREMENT, default=0.05): cv.percentage,
         cv.Optional(CONF_VOLUME_MAX, default=1.0): cv.percentage,
         cv.Optional(CONF_VOLUME_MIN, default=0.0): cv.percentage,
@@ -159,6 +182,10 @@ CONFIG_SCHEMA = media_player.MEDIA_PLAYER_SCHEMA.extend(
         cv.Optional(CONF_ON_MUTE): automation.validate_automation(single=True),
         cv.Optional(CONF_ON_UNMUTE): automation.validate_automation(single=True),
         cv.Optional(CONF_ON_VOLUME): automation.validate_automation(single=True),
+        cv.Optional(CONF_ON_OUTPUT_STANDBY): automation.validate_automation(
+            single=True
+        ),
+        cv.Optional(CONF_ON_OUTPUT_WAKE): automation.validate_automation(single=True),
     }
 )
 
@@ -176,6 +203,10 @@ def _read_audio_file_and_type(file_config):
     with open(path, "rb") as f:
         data = f.read()
 
+    if data.startswith(b"qoaf"):
+        # Not recognized by the file type libraries
+        return data, MEDIA_FILE_TYPE_ENUM["QOA"]
+
     try:
         import puremagic
 
@@ -205,14 +236,38 @@ def _read_audio_file_and_type(file_config):
 def _supported_local_file_validate(config):
     if files_list := config.get(CONF_FILES):
         for file_config in files_list:
-            _, media_file_type = _read_audio_file_and_type(file_config)
+            data, media_file_type = _read_audio_file_and_type(file_config)
             if str(media_file_type) == str(MEDIA_FILE_TYPE_ENUM["NONE"]):
                 raise cv.Invalid("Unsupported local media file.")
+            if file_config.get(CONF_TRANSCODE) == TRANSCODE_QOA:
+                if str(media_file_type) != str(MEDIA_FILE_TYPE_ENUM["WAV"]):
+                    raise cv.Invalid("Only WAV files can be transcoded to QOA.")
+                try:
+                    qoa.read_pcm_wav(data)
+                except ValueError as exc:
+                    raise cv.Invalid(f"Unable to transcode to QOA: {exc}") from exc
 
 
 FINAL_VALIDATE_SCHEMA = _supported_local_file_validate
 
 
+def _transcode_to_qoa(file_config, data):
+    samples, channels, sample_rate = qoa.read_pcm_wav(data)
+    encoded, snr = qoa.encode(samples, channels, sample_rate)
+
+    # Report the trade-off: flash saved versus the quality lost
+    pcm_size = len(samples) * 2
+    _LOGGER.info(
+        "Transcoded %s to QOA: %d -> %d bytes (%.1fx smaller than PCM), SNR %.1f dB",
+        file_config[CONF_ID],
+        len(data),
+        len(encoded),
+        pcm_size / max(len(encoded), 1),
+        snr,
+    )
+    return encoded, MEDIA_FILE_TYPE_ENUM["QOA"]
+
+
 async def to_code(config):
     cg.add_library("esphome/esp-audio-libs", "1.0.0")
 
@@ -224,6 +279,21 @@ async def to_code(config):
 
     cg.add(var.set_sample_rate(config[CONF_SAMPLE_RATE]))
 
+    if mixer_block_duration := config.get(CONF_MIXER_BLOCK_DURATION):
+        cg.add(
+            var.set_mixer_block_duration(mixer_block_duration.total_milliseconds)
+        )
+
+    cg.add(var.set_parallel_flac_decoding(config[CONF_PARALLEL_FLAC_DECODING]))
+
+    if output_standby_timeout := config.get(CONF_OUTPUT_STANDBY_TIMEOUT):
+        cg.add(
+            var.set_output_standby(
+                output_standby_timeout.total_milliseconds,
+                config[CONF_MAX_OUTPUT_WAKE_LATENCY].total_milliseconds,
+            )
+        )
+
     cg.add(var.set_volume_increment(config[CONF_VOLUME_INCREMENT]))
     cg.add(var.set_volume_max(config[CONF_VOLUME_MAX]))
     cg.add(var.set_volume_min(config[CONF_VOLUME_MIN]))
@@ -250,6 +320,19 @@ async def to_code(config):
             on_volume,
         )
 
+    if on_output_standby := config.get(CONF_ON_OUTPUT_STANDBY):
+        await automation.build_automation(
+            var.get_output_standby_trigger(),
+            [],
+            on_output_standby,
+        )
+    if on_output_wake := config.get(CONF_ON_OUTPUT_WAKE):
+        await automation.build_automation(
+            var.get_output_wake_trigger(),
+            [],
+            on_output_wake,
+        )
+
     if audio_dac_config := config.get(CONF_AUDIO_DAC):
         aud_dac = await cg.get_variable(audio_dac_config)
         cg.add(var.set_audio_dac(aud_dac))
@@ -258,18 +341,27 @@ async def to_code(config):
         for file_config in files_list:
             data, media_file_type = _read_audio_file_and_type(file_config)
 
-            rhs = [HexInt(x) for x in data]
-            prog_arr = cg.progmem_array(file_config[CONF_RAW_DATA_ID], rhs)
+            if file_config.get(CONF_TRANSCODE) == TRANSCODE_QOA:
+                data, media_file_type = _transcode_to_qoa(file_config, data)
+
+            if asset_partition.is_enabled():
+                # The data and length are filled in from the mapped partition when the file is constructed
+                file_data = cg.nullptr
+                file_length = 0
+            else:
+                rhs = [HexInt(x) for x in data]
+                file_data = cg.progmem_array(file_config[CONF_RAW_DATA_ID], rhs)
+                file_length = len(rhs)
 
             media_files_struct = cg.StructInitializer(
                 MediaFile,
                 (
                     "data",
-                    prog_arr,
+                    file_data,
                 ),
                 (
                     "length",
-                    len(rhs),
+                    file_length,
                 ),
                 (
                     "file_type",
@@ -277,11 +369,21 @@ async def to_code(config):
                 ),
             )
 
-            cg.new_Pvariable(
+            media_file = cg.new_Pvariable(
                 file_config[CONF_ID],
                 media_files_struct,
             )
 
+            if asset_partition.is_enabled():
+                asset_name = asset_partition.add_asset(
+                    f"nabu/{file_config[CONF_ID]}", data
+                )
+                cg.add(
+                    asset_partition.load_asset(
+                        asset_name, media_file.data, media_file.length
+                    )
+                )
+
 
 DUCKING_SET_SCHEMA = cv.Schema(
     {
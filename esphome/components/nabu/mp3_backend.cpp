@@ -0,0 +1,70 @@
+#ifdef USE_ESP_IDF
+
+#include "mp3_backend.h"
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nabu {
+
+std::unique_ptr<MP3Backend> MP3Backend::create() {
+  auto backend = make_unique<HelixMP3Backend>();
+  if (!backend->init()) {
+    return nullptr;
+  }
+  return backend;
+}
+
+HelixMP3Backend::~HelixMP3Backend() {
+  if (this->decoder_ != nullptr) {
+    MP3FreeDecoder(this->decoder_);
+  }
+}
+
+bool HelixMP3Backend::init() {
+  this->decoder_ = MP3InitDecoder();
+  return this->decoder_ != nullptr;
+}
+
+MP3DecoderResult HelixMP3Backend::decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                               MP3FrameResult &frame_result) {
+  frame_result = MP3FrameResult();
+
+  // Look for the next sync word
+  int32_t offset = MP3FindSyncWord((unsigned char *) buffer, buffer_length);
+  if (offset < 0) {
+    // We may recover if we have more data
+    return MP3DecoderResult::NEED_MORE_DATA;
+  }
+
+  unsigned char *decode_current = (unsigned char *) buffer + offset;
+  int bytes_left = buffer_length - offset;
+
+  int err = MP3Decode(this->decoder_, &decode_current, &bytes_left, output_buffer, 0);
+
+  // Skip past the junk before the sync word even if the frame needs more data
+  frame_result.bytes_consumed = decode_current - buffer;
+
+  if (err) {
+    switch (err) {
+      case ERR_MP3_MAINDATA_UNDERFLOW:
+        // Not a problem. Next call to decode will provide more data.
+        return MP3DecoderResult::NEED_MORE_DATA;
+      default:
+        return MP3DecoderResult::FAILED;
+    }
+  }
+
+  MP3FrameInfo mp3_frame_info;
+  MP3GetLastFrameInfo(this->decoder_, &mp3_frame_info);
+  frame_result.samples_decoded = mp3_frame_info.outputSamps;
+  frame_result.channels = mp3_frame_info.nChans;
+  frame_result.sample_rate = mp3_frame_info.samprate;
+
+  return MP3DecoderResult::DECODED;
+}
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <mp3_decoder.h>
+
+namespace esphome {
+namespace nabu {
+
+// MP3 decoding backends used by the ``AudioDecoder``
+//  - ``HelixMP3Backend`` wraps the fixed point libhelix decoder from esp-audio-libs and is currently the only backend
+//  - Each call decodes at most one frame from a linear input buffer and reports how many bytes it consumed
+
+enum class MP3DecoderResult : uint8_t {
+  DECODED = 0,     // A frame was consumed; it may not have produced samples (e.g., skipped tags or junk)
+  NEED_MORE_DATA,  // No complete frame is in the buffer; try again with more data
+  FAILED,          // The stream can't be decoded
+};
+
+struct MP3FrameResult {
+  size_t bytes_consumed{0};
+  size_t samples_decoded{0};  // Summed over all channels
+  uint8_t channels{0};
+  uint32_t sample_rate{0};
+};
+
+class MP3Backend {
+ public:
+  virtual ~MP3Backend() = default;
+
+  /// @brief Creates the backend
+  /// @return Pointer to the backend, or nullptr if its decoder state couldn't be allocated
+  static std::unique_ptr<MP3Backend> create();
+
+  /// @brief Decodes the next frame in the buffer into interleaved 16 bit samples
+  /// @param buffer Input data; any bytes before the next sync word are skipped
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param output_buffer Buffer for the decoded samples. Must hold at least `MAX_SAMPLES_PER_FRAME` samples.
+  /// @param frame_result Filled with the bytes consumed and the decoded frame's details
+  /// @return DECODED if a frame was consumed, NEED_MORE_DATA if a complete frame isn't available, or FAILED
+  virtual MP3DecoderResult decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                        MP3FrameResult &frame_result) = 0;
+
+  static const size_t MAX_SAMPLES_PER_FRAME = 1152 * 2;
+};
+
+class HelixMP3Backend : public MP3Backend {
+ public:
+  ~HelixMP3Backend() override;
+
+  bool init();
+
+  MP3DecoderResult decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                MP3FrameResult &frame_result) override;
+
+ protected:
+  HMP3Decoder decoder_{nullptr};
+};
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
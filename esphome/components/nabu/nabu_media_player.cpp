@@ -22,9 +22,11 @@ namespace nabu {
 //  - Each stream is handled by an ``AudioPipeline`` object with three parts/tasks
 //    - ``AudioReader`` handles reading from an HTTP source or from a PROGMEM flash set at compile time
 //    - ``AudioDecoder`` handles decoding the audio file. All formats are limited to two channels and 16 bits per sample
-//      - FLAC
+//      - FLAC (decoded by the in-tree ``FLACStreamDecoder``)
+//        - Optionally, media is decoded two frames at a time; a ``FLACFrameWorker`` task decodes every second frame
 //      - WAV
-//      - MP3 (based on the libhelix decoder - a random mp3 file may be incompatible)
+//      - QOA (cheap to decode, for sounds stored in flash; local WAV files can be encoded to it at build time)
+//      - MP3 (decoded by the libhelix ``MP3Backend``; it may be incompatible with a random mp3 file)
 //    - ``AudioResampler`` handles converting the sample rate to the configured output sample rate and converting mono
 //      to stereo
 //      - The quality is not good, and it is slow! Please use audio at the configured sample rate to avoid these issues
@@ -39,11 +41,13 @@ namespace nabu {
 //    - The output ring buffer feeds the configured speaker the audio directly
 //  - Media player commands are received by the ``control`` function. The commands are added to the
 //    ``media_control_command_queue_`` to be processed in the component's loop
-//    - Starting a stream intializes the appropriate pipeline or stops it if it is already running
+//    - Starting a stream intializes the appropriate pipeline or stops it if it is already running. Neither blocks the
+//      loop; the pipeline finishes the transition in ``get_state`` once its tasks have stopped.
 //    - Volume and mute commands are achieved by the ``mute``, ``unmute``, ``set_volume`` functions. Volume changes use
 //      an ``audio_dac`` component if configured. If one isn't, software volume control is used.
-//      - Volume commands are ignored if the media control queue is full to avoid crashing when the track wheel is spun
-//      fast
+//      - Volume and mute commands aren't queued. ``control`` keeps only the latest target, and the loop applies it
+//        once, so spinning the track wheel fast results in one ``audio_dac`` update per loop
+//      - The volume and mute state is saved to flash once it has stopped changing for a couple of seconds
 //    - Pausing is sent to the ``AudioMixer`` task. It only effects the media stream.
 //  - The components main loop performs housekeeping:
 //    - It reads the media control queue and processes it directly
@@ -63,6 +67,9 @@ static const size_t TASK_DELAY_MS = 10;
 
 static const float FIRST_BOOT_DEFAULT_VOLUME = 0.5f;
 
+// Volume and mute changes are saved to flash once they stop changing for this long
+static const uint32_t VOLUME_SAVE_DELAY_MS = 2000;
+
 static const char *const TAG = "nabu_media_player";
 
 void NabuMediaPlayer::setup() {
@@ -74,6 +81,7 @@ void NabuMediaPlayer::setup() {
 
   VolumeRestoreState volume_restore_state;
   if (this->pref_.load(&volume_restore_state)) {
+    this->saved_volume_restore_state_ = volume_restore_state;
     this->set_volume_(volume_restore_state.volume);
     this->set_mute_state_(volume_restore_state.is_muted);
   } else {
@@ -125,6 +133,15 @@ esp_err_t NabuMediaPlayer::start_pipeline_(AudioPipelineType type, bool url) {
 
   if (this->audio_mixer_ == nullptr) {
     this->audio_mixer_ = make_unique<AudioMixer>();
+    if (this->mixer_block_duration_ms_.has_value()) {
+      uint32_t block_duration_ms = this->mixer_block_duration_ms_.value();
+      // Round down to a whole number of stereo frames
+      size_t block_samples = (this->sample_rate_ * block_duration_ms / 1000) * NUMBER_OF_CHANNELS;
+      this->audio_mixer_->set_block_size(block_samples, block_duration_ms);
+    }
+    if (this->output_standby_timeout_ms_ > 0) {
+      this->audio_mixer_->set_standby_timeout(this->output_standby_timeout_ms_, this->max_output_wake_latency_ms_);
+    }
     err = this->audio_mixer_->start(this->speaker_, "mixer", MIXER_TASK_PRIORITY);
     if (err != ESP_OK) {
       return err;
@@ -134,6 +151,7 @@ esp_err_t NabuMediaPlayer::start_pipeline_(AudioPipelineType type, bool url) {
   if (type == AudioPipelineType::MEDIA) {
     if (this->media_pipeline_ == nullptr) {
       this->media_pipeline_ = make_unique<AudioPipeline>(this->audio_mixer_.get(), type);
+      this->media_pipeline_->set_parallel_flac_decoding(this->parallel_flac_decoding_);
     }
 
     if (url) {
@@ -176,7 +194,15 @@ void NabuMediaPlayer::watch_media_commands_() {
   CommandEvent command_event;
   esp_err_t err = ESP_OK;
 
-  if (xQueueReceive(this->media_control_command_queue_, &media_command, 0) == pdTRUE) {
+  // Starting and stopping pipelines doesn't block, so handle every queued command now. Repeated starts of the same
+  // pipeline coalesce there; only the newest source plays.
+  const uint32_t start_us = micros();
+  uint32_t commands_handled = 0;
+
+  while (xQueueReceive(this->media_control_command_queue_, &media_command, 0) == pdTRUE) {
+    ++commands_handled;
+    err = ESP_OK;
+
     if (media_command.new_url.has_value() && media_command.new_url.value()) {
       if (media_command.announce.has_value() && media_command.announce.value()) {
         err = this->start_pipeline_(AudioPipelineType::ANNOUNCEMENT, true);
@@ -200,11 +226,6 @@ void NabuMediaPlayer::watch_media_commands_() {
       this->status_clear_error();
     }
 
-    if (media_command.volume.has_value()) {
-      this->set_volume_(media_command.volume.value());
-      this->publish_state();
-    }
-
     if (media_command.command.has_value()) {
       switch (media_command.command.value()) {
         case media_player::MEDIA_PLAYER_COMMAND_PLAY:
@@ -244,29 +265,38 @@ void NabuMediaPlayer::watch_media_commands_() {
             this->is_paused_ = true;
           }
           break;
-        case media_player::MEDIA_PLAYER_COMMAND_MUTE: {
-          this->set_mute_state_(true);
-
-          this->publish_state();
-          break;
-        }
-        case media_player::MEDIA_PLAYER_COMMAND_UNMUTE:
-          this->set_mute_state_(false);
-          this->publish_state();
-          break;
-        case media_player::MEDIA_PLAYER_COMMAND_VOLUME_UP:
-          this->set_volume_(std::min(1.0f, this->volume + this->volume_increment_));
-          this->publish_state();
-          break;
-        case media_player::MEDIA_PLAYER_COMMAND_VOLUME_DOWN:
-          this->set_volume_(std::max(0.0f, this->volume - this->volume_increment_));
-          this->publish_state();
-          break;
         default:
           break;
       }
     }
   }
+
+  if (commands_handled > 0) {
+    ESP_LOGV(TAG, "Handled %" PRIu32 " media commands in %" PRIu32 " us", commands_handled, micros() - start_us);
+  }
+
+  this->apply_volume_commands_();
+}
+
+void NabuMediaPlayer::apply_volume_commands_() {
+  if (this->volume_commands_pending_ == 0) {
+    return;
+  }
+
+  // Volume first: setting it also sets the mute state, so a mute command received after it has to win
+  if (this->target_volume_.has_value()) {
+    this->set_volume_(this->target_volume_.value());
+  }
+  if (this->target_mute_state_.has_value()) {
+    this->set_mute_state_(this->target_mute_state_.value());
+  }
+  this->publish_state();
+
+  ESP_LOGV(TAG, "Applied %" PRIu32 " volume and mute commands at once", this->volume_commands_pending_);
+
+  this->target_volume_.reset();
+  this->target_mute_state_.reset();
+  this->volume_commands_pending_ = 0;
 }
 
 void NabuMediaPlayer::watch_mixer_() {
@@ -276,10 +306,59 @@ void NabuMediaPlayer::watch_mixer_() {
       if (event.type == EventType::WARNING) {
         ESP_LOGD(TAG, "Mixer encountered an error: %s", esp_err_to_name(event.err));
         this->status_set_error();
+      } else if (event.type == EventType::IDLE) {
+        this->set_output_standby_(true);
+      } else if (event.type == EventType::RUNNING) {
+        this->set_output_standby_(false);
       }
   }
 }
 
+void NabuMediaPlayer::set_output_standby_(bool standby) {
+  if (standby) {
+    ESP_LOGD(TAG, "Output is silent, entering standby");
+    ++this->output_wake_requests_;
+    this->speaker_->stop();
+#ifdef USE_AUDIO_DAC
+    if (this->audio_dac_ != nullptr) {
+      this->audio_dac_->set_standby(true);
+    }
+#endif
+    this->output_standby_trigger_->trigger();
+  } else {
+    ESP_LOGD(TAG, "Waking output from standby");
+    this->output_wake_trigger_->trigger();
+
+    // A newer standby request supersedes this wake; its completion mustn't release the mixer
+    const uint32_t wake_request = ++this->output_wake_requests_;
+#ifdef USE_AUDIO_DAC
+    if (this->audio_dac_ != nullptr) {
+      // The mixer holds the audio until the DAC's output stages are actually powered
+      this->audio_dac_->set_standby(false, [this, wake_request](bool success) {
+        if (!success) {
+          ESP_LOGW(TAG, "Powering up the audio DAC failed");
+        }
+        if (wake_request == this->output_wake_requests_) {
+          this->send_output_awake_();
+        }
+      });
+      return;
+    }
+#endif
+    this->send_output_awake_();
+  }
+}
+
+void NabuMediaPlayer::send_output_awake_() {
+  if (this->audio_mixer_ == nullptr) {
+    return;
+  }
+  // The speaker restarts itself on the mixer's next write
+  CommandEvent command_event;
+  command_event.command = CommandEventType::OUTPUT_AWAKE;
+  this->audio_mixer_->send_command(&command_event);
+}
+
 void NabuMediaPlayer::loop() {
   this->watch_media_commands_();
   this->watch_mixer_();
@@ -309,10 +388,13 @@ void NabuMediaPlayer::loop() {
     ESP_LOGE(TAG, "The announcement pipeline's audio resampler encountered an error.");
   }
 
-  if (this->announcement_pipeline_state_ != AudioPipelineState::STOPPED) {
+  // A pipeline that is finishing a stop already counts as stopped
+  if ((this->announcement_pipeline_state_ != AudioPipelineState::STOPPED) &&
+      (this->announcement_pipeline_state_ != AudioPipelineState::STOPPING)) {
     this->state = media_player::MEDIA_PLAYER_STATE_ANNOUNCING;
   } else {
-    if (this->media_pipeline_state_ == AudioPipelineState::STOPPED) {
+    if ((this->media_pipeline_state_ == AudioPipelineState::STOPPED) ||
+        (this->media_pipeline_state_ == AudioPipelineState::STOPPING)) {
       this->state = media_player::MEDIA_PLAYER_STATE_IDLE;
     } else if (this->is_paused_) {
       this->state = media_player::MEDIA_PLAYER_STATE_PAUSED;
@@ -360,7 +442,7 @@ void NabuMediaPlayer::control(const media_player::MediaPlayerCall &call) {
     } else {
       this->media_url_ = new_uri;
     }
-    xQueueSend(this->media_control_command_queue_, &media_command, portMAX_DELAY);
+    this->send_media_command_(media_command);
     return;
   }
 
@@ -371,29 +453,57 @@ void NabuMediaPlayer::control(const media_player::MediaPlayerCall &call) {
       this->media_file_ = call.get_local_media_file().value();
     }
     media_command.new_file = true;
-    xQueueSend(this->media_control_command_queue_, &media_command, portMAX_DELAY);
+    this->send_media_command_(media_command);
     return;
   }
 
+  // Only the latest volume and mute targets are kept; loop() applies them once, so a burst of commands (e.g., from
+  // turning the dial) results in a single audio_dac update
   if (call.get_volume().has_value()) {
-    media_command.volume = call.get_volume().value();
-    // Wait 0 ticks for queue to be free, volume sets aren't that important!
-    xQueueSend(this->media_control_command_queue_, &media_command, 0);
+    this->target_volume_ = call.get_volume().value();
+    this->target_mute_state_.reset();  // Setting the volume sets the mute state
+    ++this->volume_commands_pending_;
     return;
   }
 
   if (call.get_command().has_value()) {
-    media_command.command = call.get_command().value();
-    TickType_t ticks_to_wait = portMAX_DELAY;
-    if ((call.get_command().value() == media_player::MEDIA_PLAYER_COMMAND_VOLUME_UP) ||
-        (call.get_command().value() == media_player::MEDIA_PLAYER_COMMAND_VOLUME_DOWN)) {
-      ticks_to_wait = 0;  // Wait 0 ticks for queue to be free, volume sets aren't that important!
+    switch (call.get_command().value()) {
+      case media_player::MEDIA_PLAYER_COMMAND_MUTE:
+        this->target_mute_state_ = true;
+        ++this->volume_commands_pending_;
+        return;
+      case media_player::MEDIA_PLAYER_COMMAND_UNMUTE:
+        this->target_mute_state_ = false;
+        ++this->volume_commands_pending_;
+        return;
+      case media_player::MEDIA_PLAYER_COMMAND_VOLUME_UP:
+        this->target_volume_ = std::min(1.0f, this->target_volume_.value_or(this->volume) + this->volume_increment_);
+        this->target_mute_state_.reset();
+        ++this->volume_commands_pending_;
+        return;
+      case media_player::MEDIA_PLAYER_COMMAND_VOLUME_DOWN:
+        this->target_volume_ = std::max(0.0f, this->target_volume_.value_or(this->volume) - this->volume_increment_);
+        this->target_mute_state_.reset();
+        ++this->volume_commands_pending_;
+        return;
+      default:
+        break;
     }
-    xQueueSend(this->media_control_command_queue_, &media_command, ticks_to_wait);
+
+    media_command.command = call.get_command().value();
+    this->send_media_command_(media_command);
     return;
   }
 }
 
+void NabuMediaPlayer::send_media_command_(const MediaCallCommand &media_command) {
+  // control() and the loop that receives the commands both run on the main loop, so waiting for space would never
+  // end
+  if (xQueueSend(this->media_control_command_queue_, &media_command, 0) != pdTRUE) {
+    ESP_LOGW(TAG, "Media command queue is full; dropping the command");
+  }
+}
+
 media_player::MediaPlayerTraits NabuMediaPlayer::get_traits() {
   auto traits = media_player::MediaPlayerTraits();
   traits.set_supports_pause(true);
@@ -413,10 +523,21 @@ media_player::MediaPlayerTraits NabuMediaPlayer::get_traits() {
 };
 
 void NabuMediaPlayer::save_volume_restore_state_() {
-  VolumeRestoreState volume_restore_state;
-  volume_restore_state.volume = this->volume;
-  volume_restore_state.is_muted = this->is_muted_;
-  this->pref_.save(&volume_restore_state);
+  ++this->volume_saves_deferred_;
+  this->set_timeout("save_volume", VOLUME_SAVE_DELAY_MS, [this]() {
+    VolumeRestoreState volume_restore_state;
+    volume_restore_state.volume = this->volume;
+    volume_restore_state.is_muted = this->is_muted_;
+
+    if ((volume_restore_state.volume != this->saved_volume_restore_state_.volume) ||
+        (volume_restore_state.is_muted != this->saved_volume_restore_state_.is_muted)) {
+      this->pref_.save(&volume_restore_state);
+      this->saved_volume_restore_state_ = volume_restore_state;
+      ESP_LOGD(TAG, "Saved volume and mute state; %" PRIu32 " changes coalesced into one write",
+               this->volume_saves_deferred_);
+    }
+    this->volume_saves_deferred_ = 0;
+  });
 }
 
 void NabuMediaPlayer::set_mute_state_(bool mute_state) {
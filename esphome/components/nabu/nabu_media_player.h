@@ -25,7 +25,6 @@ namespace nabu {
 
 struct MediaCallCommand {
   optional<media_player::MediaPlayerCommand> command;
-  optional<float> volume;
   optional<bool> announce;
   optional<bool> new_url;
   optional<bool> new_file;
@@ -53,6 +52,18 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
 
   void set_sample_rate(uint32_t sample_rate) { this->sample_rate_ = sample_rate; }
 
+  /// @brief Sets the duration of audio the mixer processes in each block. Shorter blocks reduce latency for
+  /// announcements, ducking, and pausing, but increase the per-block CPU overhead.
+  void set_mixer_block_duration(uint32_t mixer_block_duration_ms) {
+    this->mixer_block_duration_ms_ = mixer_block_duration_ms;
+  }
+
+  /// @brief Decodes FLAC media two frames at a time on both cores. Frees time on the core that also runs wake word
+  /// inference, at the cost of a second decoder and a worker task.
+  void set_parallel_flac_decoding(bool parallel_flac_decoding) {
+    this->parallel_flac_decoding_ = parallel_flac_decoding;
+  }
+
   // Percentage to increase or decrease the volume for volume up or volume down commands
   void set_volume_increment(float volume_increment) { this->volume_increment_ = volume_increment; }
 
@@ -65,15 +76,31 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
 
   void set_speaker(speaker::Speaker *speaker) { this->speaker_ = speaker; }
 
+  /// @brief Enables putting the output into standby after the mixed audio has been silent for a while
+  /// @param standby_timeout_ms Duration of silence before entering standby
+  /// @param max_wake_latency_ms Maximum time the mixer holds audio while the output wakes up
+  void set_output_standby(uint32_t standby_timeout_ms, uint32_t max_wake_latency_ms) {
+    this->output_standby_timeout_ms_ = standby_timeout_ms;
+    this->max_output_wake_latency_ms_ = max_wake_latency_ms;
+  }
+
   Trigger<> *get_mute_trigger() const { return this->mute_trigger_; }
   Trigger<> *get_unmute_trigger() const { return this->unmute_trigger_; }
   Trigger<float> *get_volume_trigger() const { return this->volume_trigger_; }
+  Trigger<> *get_output_standby_trigger() const { return this->output_standby_trigger_; }
+  Trigger<> *get_output_wake_trigger() const { return this->output_wake_trigger_; }
 
  protected:
   // Receives commands from HA or from the voice assistant component
-  // Sends commands to the media_control_commanda_queue_
+  // Sends commands to the media_control_commanda_queue_; volume and mute commands update the pending targets instead
   void control(const media_player::MediaPlayerCall &call) override;
 
+  /// @brief Adds a command to media_control_command_queue_ without blocking. Drops it if the queue is full.
+  void send_media_command_(const MediaCallCommand &media_command);
+
+  /// @brief Applies the latest volume and mute targets received since the last loop, then publishes the state once
+  void apply_volume_commands_();
+
   /// @brief Updates this->volume and saves volume/mute state to flash for restortation if publish is true.
   void set_volume_(float volume, bool publish = true);
 
@@ -82,7 +109,8 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
   /// @param mute_state If true, audio will be muted. If false, audio will be unmuted
   void set_mute_state_(bool mute_state);
 
-  /// @brief Saves the current volume and mute state to the flash for restoration.
+  /// @brief Saves the current volume and mute state to the flash for restoration once it stops changing for
+  /// VOLUME_SAVE_DELAY_MS. Skips the write if the state matches what was last saved.
   void save_volume_restore_state_();
 
   // Reads commands from media_control_command_queue_. Starts pipelines and mixer if necessary.
@@ -97,6 +125,16 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
   // Monitors the mixer task
   void watch_mixer_();
 
+  /// @brief Powers down or up the output hardware (speaker, audio_dac, and any amp via the triggers)
+  /// @param standby If true, the output enters standby. If false, it wakes and the mixer is notified.
+  void set_output_standby_(bool standby);
+
+  /// @brief Tells the mixer the output hardware is powered, so it can release the held audio
+  void send_output_awake_();
+
+  // Incremented by every standby and wake request; a DAC power-up completion only counts for the latest wake
+  uint32_t output_wake_requests_{0};
+
   // Starts the ``type`` pipeline with a ``url`` or file. Starts the mixer, pipeline, and speaker tasks if necessary.
   // Unpauses if starting media in paused state
   esp_err_t start_pipeline_(AudioPipelineType type, bool url);
@@ -113,6 +151,14 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
 
   uint32_t sample_rate_;
 
+  optional<uint32_t> mixer_block_duration_ms_{};
+
+  bool parallel_flac_decoding_{false};
+
+  // Standby is disabled if the timeout is 0
+  uint32_t output_standby_timeout_ms_{0};
+  uint32_t max_output_wake_latency_ms_{0};
+
   bool is_paused_{false};
   bool is_muted_{false};
 
@@ -126,12 +172,21 @@ class NabuMediaPlayer : public Component, public media_player::MediaPlayer {
   audio_dac::AudioDac *audio_dac_{nullptr};
 #endif
 
+  // Latest volume and mute commands that haven't been applied yet
+  optional<float> target_volume_{};
+  optional<bool> target_mute_state_{};
+  uint32_t volume_commands_pending_{0};
+
   // Used to save volume/mute state for restoration on reboot
   ESPPreferenceObject pref_;
+  VolumeRestoreState saved_volume_restore_state_{-1.0f, false};  // Never matches a real volume until the first save
+  uint32_t volume_saves_deferred_{0};
 
   Trigger<> *mute_trigger_ = new Trigger<>();
   Trigger<> *unmute_trigger_ = new Trigger<>();
   Trigger<float> *volume_trigger_ = new Trigger<float>();
+  Trigger<> *output_standby_trigger_ = new Trigger<>();
+  Trigger<> *output_wake_trigger_ = new Trigger<>();
 };
 
 template<typename... Ts> class DuckingSetAction : public Action<Ts...>, public Parented<NabuMediaPlayer> {
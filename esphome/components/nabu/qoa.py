@@ -0,0 +1,156 @@
+"""Build time encoder for the QOA (Quite OK Audio) format decoded by ``QOADecoder``.
+
+QOA stores 20 samples per 64 bit slice (3.2 bits per sample) using a 4 tap sign-sign LMS
+predictor. For each slice, the encoder tries all 16 scale factors and keeps the one with
+the smallest squared error.
+"""
+
+import io
+import math
+import struct
+import wave
+
+LMS_TAPS = 4
+SLICE_LEN = 20
+SLICES_PER_FRAME = 256
+FRAME_LEN = SLICES_PER_FRAME * SLICE_LEN
+
+_SCALEFACTORS = [round(pow(s + 1, 2.75)) for s in range(16)]
+_RECIPROCALS = [((1 << 16) + sf - 1) // sf for sf in _SCALEFACTORS]
+_QUANTIZATION = [7, 7, 7, 5, 5, 3, 3, 1, 0, 0, 2, 2, 4, 4, 6, 6, 6]  # Indexed by -8..8
+
+
+def _round_half_away(value):
+    return int(math.floor(abs(value) + 0.5)) * (1 if value >= 0 else -1)
+
+
+_DEQUANTIZATION = [
+    [_round_half_away(sf * d) for d in (0.75, -0.75, 2.5, -2.5, 4.5, -4.5, 7, -7)]
+    for sf in _SCALEFACTORS
+]
+
+
+def _sign(value):
+    return (value > 0) - (value < 0)
+
+
+def _divide(value, scalefactor_index):
+    # Rounding division using the reciprocal, matching the reference encoder
+    n = (value * _RECIPROCALS[scalefactor_index] + (1 << 15)) >> 16
+    return n + _sign(value) - _sign(n)
+
+
+def _clamp(value, low, high):
+    return low if value < low else high if value > high else value
+
+
+def _pack_s16(values):
+    packed = 0
+    for v in values:
+        packed = (packed << 16) | (v & 0xFFFF)
+    return packed
+
+
+def read_pcm_wav(data: bytes):
+    """Returns the interleaved samples, channel count, and sample rate of a 16 bit PCM WAV file."""
+    try:
+        with wave.open(io.BytesIO(data), "rb") as wav:
+            if wav.getsampwidth() != 2:
+                raise ValueError("only 16 bit PCM WAV files can be encoded")
+            channels = wav.getnchannels()
+            sample_rate = wav.getframerate()
+            frames = wav.readframes(wav.getnframes())
+    except (wave.Error, EOFError) as exc:
+        raise ValueError(str(exc)) from exc
+    samples = list(struct.unpack(f"<{len(frames) // 2}h", frames))
+    return samples, channels, sample_rate
+
+
+def encode(samples, channels, sample_rate):
+    """Encodes interleaved 16 bit samples.
+
+    Returns the QOA file and the signal to noise ratio (dB) of the decoded result.
+    """
+    total = len(samples) // channels
+    out = bytearray(b"qoaf" + struct.pack(">I", total))
+
+    # Initial predictor state; the decoder reads it from each frame header
+    histories = [[0, 0, 0, 0] for _ in range(channels)]
+    weights = [[0, 0, -(1 << 13), 1 << 14] for _ in range(channels)]
+    previous_scalefactors = [0] * channels
+
+    signal_energy = 0
+    noise_energy = 0
+
+    for frame_start in range(0, total, FRAME_LEN):
+        frame_len = min(FRAME_LEN, total - frame_start)
+        slices = (frame_len + SLICE_LEN - 1) // SLICE_LEN
+        frame_size = 8 + 16 * channels + 8 * slices * channels
+        out += struct.pack(
+            ">B3sHH",
+            channels,
+            sample_rate.to_bytes(3, "big"),
+            frame_len,
+            frame_size,
+        )
+        for c in range(channels):
+            out += struct.pack(">QQ", _pack_s16(histories[c]), _pack_s16(weights[c]))
+
+        for slice_start in range(frame_start, frame_start + frame_len, SLICE_LEN):
+            slice_len = min(SLICE_LEN, frame_start + frame_len - slice_start)
+            for c in range(channels):
+                best = None
+                for offset in range(16):
+                    sf = (offset + previous_scalefactors[c]) & 15
+                    history = list(histories[c])
+                    weight = list(weights[c])
+                    packed = sf
+                    rank = 0
+                    error_sum = 0
+                    for i in range(slice_len):
+                        sample = samples[(slice_start + i) * channels + c]
+                        predicted = (
+                            weight[0] * history[0]
+                            + weight[1] * history[1]
+                            + weight[2] * history[2]
+                            + weight[3] * history[3]
+                        ) >> 13
+                        residual = sample - predicted
+                        quantized = _QUANTIZATION[
+                            _clamp(_divide(residual, sf), -8, 8) + 8
+                        ]
+                        dequantized = _DEQUANTIZATION[sf][quantized]
+                        reconstructed = _clamp(predicted + dequantized, -32768, 32767)
+
+                        # Penalize large weights so the predictor can't become unstable
+                        penalty = max(0, (sum(w * w for w in weight) >> 18) - 0x8FF)
+                        error = sample - reconstructed
+                        rank += error * error + penalty * penalty
+                        error_sum += error * error
+                        if best is not None and rank > best[0]:
+                            break
+
+                        delta = dequantized >> 4
+                        for t in range(LMS_TAPS):
+                            weight[t] += -delta if history[t] < 0 else delta
+                        history = history[1:] + [reconstructed]
+                        packed = (packed << 3) | quantized
+                    else:
+                        if best is None or rank < best[0]:
+                            best = (rank, packed, history, weight, sf, error_sum)
+
+                _, packed, histories[c], weights[c], sf, error_sum = best
+                previous_scalefactors[c] = sf
+                packed <<= (SLICE_LEN - slice_len) * 3
+                out += struct.pack(">Q", packed)
+
+                noise_energy += error_sum
+                for i in range(slice_len):
+                    sample = samples[(slice_start + i) * channels + c]
+                    signal_energy += sample * sample
+
+    if noise_energy == 0:
+        snr = math.inf
+    else:
+        snr = 10 * math.log10(max(signal_energy, 1) / noise_energy)
+    return bytes(out), snr
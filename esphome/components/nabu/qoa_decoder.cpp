@@ -0,0 +1,181 @@
+#ifdef USE_ESP_IDF
+
+#include "qoa_decoder.h"
+
+namespace esphome {
+namespace nabu {
+
+static const size_t FILE_HEADER_LENGTH = 8;
+static const size_t FRAME_HEADER_LENGTH = 8;
+static const size_t LMS_STATE_LENGTH = 16;  // Per channel: 4 history samples and 4 weights
+static const size_t SLICE_LENGTH = 8;
+
+static const uint8_t LMS_TAPS = 4;
+static const uint16_t SAMPLES_PER_SLICE = 20;
+static const uint16_t MAX_SAMPLES_PER_FRAME = 256 * SAMPLES_PER_SLICE;
+
+// Residual for each scale factor and 3 bit quantized value: round((s + 1)^2.75 * {0.75, -0.75, 2.5, ..., -7})
+static const int16_t DEQUANTIZATION_TABLE[16][8] = {
+    {1, -1, 3, -3, 5, -5, 7, -7},
+    {5, -5, 18, -18, 32, -32, 49, -49},
+    {16, -16, 53, -53, 95, -95, 147, -147},
+    {34, -34, 113, -113, 203, -203, 315, -315},
+    {63, -63, 210, -210, 378, -378, 588, -588},
+    {104, -104, 345, -345, 621, -621, 966, -966},
+    {158, -158, 528, -528, 950, -950, 1477, -1477},
+    {228, -228, 760, -760, 1368, -1368, 2128, -2128},
+    {316, -316, 1053, -1053, 1895, -1895, 2947, -2947},
+    {422, -422, 1405, -1405, 2529, -2529, 3934, -3934},
+    {548, -548, 1828, -1828, 3290, -3290, 5117, -5117},
+    {696, -696, 2320, -2320, 4176, -4176, 6496, -6496},
+    {868, -868, 2893, -2893, 5207, -5207, 8099, -8099},
+    {1064, -1064, 3548, -3548, 6386, -6386, 9933, -9933},
+    {1286, -1286, 4288, -4288, 7718, -7718, 12005, -12005},
+    {1536, -1536, 5120, -5120, 9216, -9216, 14336, -14336},
+};
+
+static inline uint16_t read_u16(const uint8_t *data) { return (data[0] << 8) | data[1]; }
+static inline uint32_t read_u24(const uint8_t *data) { return (data[0] << 16) | (data[1] << 8) | data[2]; }
+static inline uint32_t read_u32(const uint8_t *data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+static inline uint64_t read_u64(const uint8_t *data) {
+  return (static_cast<uint64_t>(read_u32(data)) << 32) | read_u32(data + 4);
+}
+
+static inline int32_t clamp_s16(int32_t value) {
+  if (static_cast<uint32_t>(value + 32768) > 65535) {
+    return (value < -32768) ? -32768 : 32767;
+  }
+  return value;
+}
+
+QOADecoderResult QOADecoder::read_header(const uint8_t *buffer, size_t buffer_length, size_t &bytes_consumed) {
+  bytes_consumed = 0;
+
+  if (buffer_length < FILE_HEADER_LENGTH + FRAME_HEADER_LENGTH) {
+    return QOADecoderResult::HEADER_OUT_OF_DATA;
+  }
+
+  if ((buffer[0] != 'q') || (buffer[1] != 'o') || (buffer[2] != 'a') || (buffer[3] != 'f')) {
+    return QOADecoderResult::ERROR_BAD_MAGIC_NUMBER;
+  }
+
+  this->total_samples_ = read_u32(buffer + 4);
+
+  // Every frame repeats the channel count and sample rate; they must not change within the file
+  const uint8_t *frame_header = buffer + FILE_HEADER_LENGTH;
+  this->num_channels_ = frame_header[0];
+  this->sample_rate_ = read_u24(frame_header + 1);
+
+  if ((this->num_channels_ == 0) || (this->sample_rate_ == 0)) {
+    return QOADecoderResult::ERROR_BAD_HEADER;
+  }
+
+  this->samples_decoded_ = 0;
+  bytes_consumed = FILE_HEADER_LENGTH;
+
+  return QOADecoderResult::SUCCESS;
+}
+
+QOADecoderResult QOADecoder::decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                          size_t &samples_decoded, size_t &bytes_consumed) {
+  samples_decoded = 0;
+  bytes_consumed = 0;
+
+  if (buffer_length < FRAME_HEADER_LENGTH) {
+    return QOADecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  const uint8_t channels = buffer[0];
+  const uint32_t sample_rate = read_u24(buffer + 1);
+  const uint16_t frame_samples = read_u16(buffer + 4);
+  const uint16_t frame_size = read_u16(buffer + 6);
+
+  const size_t slices = (frame_samples + SAMPLES_PER_SLICE - 1) / SAMPLES_PER_SLICE * channels;
+  const size_t expected_size = FRAME_HEADER_LENGTH + LMS_STATE_LENGTH * channels + SLICE_LENGTH * slices;
+
+  if ((channels != this->num_channels_) || (sample_rate != this->sample_rate_) || (frame_samples == 0) ||
+      (frame_samples > MAX_SAMPLES_PER_FRAME) || (frame_size != expected_size)) {
+    return QOADecoderResult::ERROR_BAD_HEADER;
+  }
+
+  if (frame_size > buffer_length) {
+    return QOADecoderResult::ERROR_OUT_OF_DATA;
+  }
+
+  const uint8_t *current = buffer + FRAME_HEADER_LENGTH;
+
+  for (uint8_t channel = 0; channel < channels; ++channel) {
+    // The predictor state is kept in locals so it stays in registers for the whole channel
+    int32_t history[LMS_TAPS];
+    int32_t weights[LMS_TAPS];
+    uint64_t packed_history = read_u64(current);
+    uint64_t packed_weights = read_u64(current + 8);
+    for (uint8_t i = 0; i < LMS_TAPS; ++i) {
+      history[i] = static_cast<int16_t>(packed_history >> 48);
+      weights[i] = static_cast<int16_t>(packed_weights >> 48);
+      packed_history <<= 16;
+      packed_weights <<= 16;
+    }
+    current += LMS_STATE_LENGTH;
+
+    // Slices are interleaved by channel
+    const uint8_t *slice_data = buffer + FRAME_HEADER_LENGTH + LMS_STATE_LENGTH * channels + SLICE_LENGTH * channel;
+    int16_t *output = output_buffer + channel;
+
+    for (uint16_t slice_start = 0; slice_start < frame_samples; slice_start += SAMPLES_PER_SLICE) {
+      uint64_t slice = read_u64(slice_data);
+      slice_data += SLICE_LENGTH * channels;
+
+      const int16_t *dequantized_values = DEQUANTIZATION_TABLE[slice >> 60];
+      slice <<= 4;
+
+      uint16_t slice_samples = frame_samples - slice_start;
+      if (slice_samples > SAMPLES_PER_SLICE) {
+        slice_samples = SAMPLES_PER_SLICE;
+      }
+
+      for (uint16_t i = 0; i < slice_samples; ++i) {
+        int32_t prediction = (weights[0] * history[0] + weights[1] * history[1] + weights[2] * history[2] +
+                              weights[3] * history[3]) >>
+                             13;
+        int32_t dequantized = dequantized_values[slice >> 61];
+        slice <<= 3;
+
+        int32_t reconstructed = clamp_s16(prediction + dequantized);
+        *output = reconstructed;
+        output += channels;
+
+        // Sign-sign LMS update
+        int32_t delta = dequantized >> 4;
+        weights[0] += (history[0] < 0) ? -delta : delta;
+        weights[1] += (history[1] < 0) ? -delta : delta;
+        weights[2] += (history[2] < 0) ? -delta : delta;
+        weights[3] += (history[3] < 0) ? -delta : delta;
+
+        history[0] = history[1];
+        history[1] = history[2];
+        history[2] = history[3];
+        history[3] = reconstructed;
+      }
+    }
+  }
+
+  samples_decoded = frame_samples * channels;
+  bytes_consumed = frame_size;
+  this->samples_decoded_ += frame_samples;
+
+  if ((this->total_samples_ > 0) && (this->samples_decoded_ >= this->total_samples_)) {
+    return QOADecoderResult::NO_MORE_FRAMES;
+  }
+
+  return QOADecoderResult::SUCCESS;
+}
+
+size_t QOADecoder::get_output_buffer_size() const { return MAX_SAMPLES_PER_FRAME * this->num_channels_; }
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
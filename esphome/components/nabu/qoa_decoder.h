@@ -0,0 +1,66 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace nabu {
+
+// Decoder for the QOA (Quite OK Audio) format used by the ``AudioDecoder``
+//  - QOA is a lossy, fixed ratio codec: 3.2 bits per sample with every frame independently decodable
+//  - Decoding is a 4 tap sign-sign LMS predictor plus a table lookup per sample, so it costs far less CPU than MP3
+//    or FLAC. It is meant for short sounds stored in flash; ``media_player.py`` can encode local WAV files to it.
+//  - Each frame holds up to 5120 samples per channel and states its own size, so no sync search is needed
+
+enum class QOADecoderResult : uint8_t {
+  SUCCESS = 0,
+  NO_MORE_FRAMES,          // Decoded the final frame of the stream
+  HEADER_OUT_OF_DATA,      // The header isn't complete; try again with more data
+  ERROR_OUT_OF_DATA,       // The frame isn't complete; try again with more data
+  ERROR_BAD_MAGIC_NUMBER,  // Anything with a greater value is a corrupt frame or unsupported stream
+  ERROR_BAD_HEADER,
+  ERROR_UNSUPPORTED,
+};
+
+class QOADecoder {
+ public:
+  /// @brief Reads the file header and the stream parameters from the first frame's header
+  /// @param buffer Input data starting at the beginning of the file
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param bytes_consumed Set to the number of bytes used by the file header if successful. The first frame's header
+  /// is only inspected, not consumed.
+  /// @return SUCCESS if the header was read, HEADER_OUT_OF_DATA if more data is needed, or an error
+  QOADecoderResult read_header(const uint8_t *buffer, size_t buffer_length, size_t &bytes_consumed);
+
+  /// @brief Decodes a single frame into interleaved 16 bit samples
+  /// @param buffer Input data starting at a frame header
+  /// @param buffer_length Number of bytes available in the buffer
+  /// @param output_buffer Buffer for the decoded samples. Must hold at least `get_output_buffer_size()` samples.
+  /// @param samples_decoded Set to the number of samples (summed over all channels) decoded
+  /// @param bytes_consumed Set to the number of bytes used by the frame if successful
+  /// @return SUCCESS or NO_MORE_FRAMES if a frame was decoded, ERROR_OUT_OF_DATA if the frame is incomplete, or an
+  /// error if the frame is corrupt
+  QOADecoderResult decode_frame(const uint8_t *buffer, size_t buffer_length, int16_t *output_buffer,
+                                size_t &samples_decoded, size_t &bytes_consumed);
+
+  uint32_t get_sample_rate() const { return this->sample_rate_; }
+  uint8_t get_num_channels() const { return this->num_channels_; }
+  uint32_t get_total_samples() const { return this->total_samples_; }
+
+  /// @brief Minimum size of the output buffer passed to `decode_frame`
+  /// @return Number of int16_t samples
+  size_t get_output_buffer_size() const;
+
+ protected:
+  uint32_t sample_rate_{0};
+  uint8_t num_channels_{0};
+  uint32_t total_samples_{0};  // Per channel; 0 for a stream of unknown length
+  uint32_t samples_decoded_{0};
+};
+
+}  // namespace nabu
+}  // namespace esphome
+
+#endif
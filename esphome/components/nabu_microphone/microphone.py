@@ -30,6 +30,7 @@ CONF_USE_APLL = "use_apll"
 CONF_CHANNEL_0 = "channel_0"
 CONF_CHANNEL_1 = "channel_1"
 CONF_AMPLIFY_SHIFT = "amplify_shift"
+CONF_KEEP_DRIVER_INSTALLED = "keep_driver_installed"
 
 nabu_microphone_ns = cg.esphome_ns.namespace("nabu_microphone")
 
@@ -62,15 +63,37 @@ def validate_esp32_variant(config):
     raise NotImplementedError
 
 
+MAX_DECIMATION_FACTOR = 6
+
 MICROPHONE_CHANNEL_SCHEMA = microphone.MICROPHONE_SCHEMA.extend(
             {
                 cv.GenerateID(): cv.declare_id(NabuMicrophoneChannel),
                 cv.Optional(CONF_AMPLIFY_SHIFT, default=0): cv.All(
                     cv.uint8_t, cv.Range(min=0, max=8)
                 ),
+                cv.Optional(CONF_SAMPLE_RATE): cv.int_range(min=1),
             }
         )
 
+
+def validate_output_sample_rates(config):
+    # Each output is decimated from the capture by an integer factor in the read task
+    capture_rate = config[CONF_SAMPLE_RATE]
+    for channel in (CONF_CHANNEL_0, CONF_CHANNEL_1):
+        for output in config.get(channel, []):
+            output_rate = output.get(CONF_SAMPLE_RATE, capture_rate)
+            if capture_rate % output_rate != 0:
+                raise cv.Invalid(
+                    f"The capture sample rate ({capture_rate} Hz) must be a multiple of the output sample rate ({output_rate} Hz)",
+                    path=[channel, CONF_SAMPLE_RATE],
+                )
+            if capture_rate // output_rate > MAX_DECIMATION_FACTOR:
+                raise cv.Invalid(
+                    f"The output sample rate ({output_rate} Hz) must be at least 1/{MAX_DECIMATION_FACTOR} of the capture sample rate",
+                    path=[channel, CONF_SAMPLE_RATE],
+                )
+    return config
+
 BASE_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(NabuMicrophone),
@@ -83,8 +106,9 @@ BASE_SCHEMA = cv.Schema(
             I2S_MODE_OPTIONS, lower=True
         ),
         cv.Optional(CONF_USE_APLL, default=False): cv.boolean,
-        cv.Optional(CONF_CHANNEL_0): MICROPHONE_CHANNEL_SCHEMA,
-        cv.Optional(CONF_CHANNEL_1): MICROPHONE_CHANNEL_SCHEMA,
+        cv.Optional(CONF_KEEP_DRIVER_INSTALLED, default=False): cv.boolean,
+        cv.Optional(CONF_CHANNEL_0): cv.ensure_list(MICROPHONE_CHANNEL_SCHEMA),
+        cv.Optional(CONF_CHANNEL_1): cv.ensure_list(MICROPHONE_CHANNEL_SCHEMA),
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
@@ -106,6 +130,7 @@ CONFIG_SCHEMA = cv.All(
         key=CONF_ADC_TYPE,
     ),
     validate_esp32_variant,
+    validate_output_sample_rates,
 )
 
 
@@ -115,21 +140,17 @@ async def to_code(config):
 
     await cg.register_parented(var, config[CONF_I2S_AUDIO_ID])
 
-    if channel_0_config := config.get(CONF_CHANNEL_0):
-        channel_0 = cg.new_Pvariable(channel_0_config[CONF_ID])
-        await cg.register_component(channel_0, channel_0_config)
-        await cg.register_parented(channel_0, config[CONF_ID])
-        await microphone.register_microphone(channel_0, channel_0_config)
-        cg.add(var.set_channel_0(channel_0))
-        cg.add(channel_0.set_amplify_shift(channel_0_config[CONF_AMPLIFY_SHIFT]))
-
-    if channel_1_config := config.get(CONF_CHANNEL_1):
-        channel_1 = cg.new_Pvariable(channel_1_config[CONF_ID])
-        await cg.register_component(channel_1, channel_1_config)
-        await cg.register_parented(channel_1, config[CONF_ID])
-        await microphone.register_microphone(channel_1, channel_1_config)
-        cg.add(var.set_channel_1(channel_1))
-        cg.add(channel_1.set_amplify_shift(channel_1_config[CONF_AMPLIFY_SHIFT]))
+    for source_channel, channel in enumerate((CONF_CHANNEL_0, CONF_CHANNEL_1)):
+        for output_config in config.get(channel, []):
+            output = cg.new_Pvariable(output_config[CONF_ID])
+            await cg.register_component(output, output_config)
+            await cg.register_parented(output, config[CONF_ID])
+            await microphone.register_microphone(output, output_config)
+            cg.add(var.add_channel(output))
+            cg.add(output.set_source_channel(source_channel))
+            cg.add(output.set_amplify_shift(output_config[CONF_AMPLIFY_SHIFT]))
+            if sample_rate := output_config.get(CONF_SAMPLE_RATE):
+                cg.add(output.set_sample_rate(sample_rate))
 
     if config[CONF_ADC_TYPE] == "internal":
         variant = esp32.get_esp32_variant()
@@ -143,6 +164,7 @@ async def to_code(config):
     cg.add(var.set_sample_rate(config[CONF_SAMPLE_RATE]))
     cg.add(var.set_bits_per_sample(config[CONF_BITS_PER_SAMPLE]))
     cg.add(var.set_use_apll(config[CONF_USE_APLL]))
+    cg.add(var.set_keep_driver_installed(config[CONF_KEEP_DRIVER_INSTALLED]))
     cg.add(var.set_i2s_mode(config[CONF_I2S_MODE]))
 
     cg.add_define("USE_OTA_STATE_CALLBACK")
@@ -7,7 +7,6 @@
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
-#include "esphome/core/ring_buffer.h"
 
 #ifdef USE_OTA
 #include "esphome/components/ota/ota_backend.h"
@@ -20,12 +19,17 @@ static const size_t RING_BUFFER_LENGTH = 64;  // Measured in milliseconds
 static const size_t QUEUE_LENGTH = 10;
 
 static const size_t NUMBER_OF_CHANNELS = 2;
-static const size_t DMA_BUFFER_SIZE = 160;
+static const size_t DMA_BUFFER_DURATION_MS = 10;
 static const size_t DMA_BUFFERS_COUNT = 4;
-static const size_t FRAMES_IN_ALL_DMA_BUFFERS = DMA_BUFFER_SIZE * DMA_BUFFERS_COUNT;
-static const size_t SAMPLES_IN_ALL_DMA_BUFFERS = FRAMES_IN_ALL_DMA_BUFFERS * NUMBER_OF_CHANNELS;
 
-static const size_t TASK_DELAY_MS = 10;
+// The driver posts an event from its DMA interrupt for every received buffer; the read task only wakes for those
+static const size_t I2S_EVENT_QUEUE_LENGTH = DMA_BUFFERS_COUNT;
+
+// If no DMA buffer arrives within this time, the I2S bus has stalled (e.g., the primary stopped its clocks)
+static const size_t DMA_TIMEOUT_MS = 100;
+
+// How often the read task logs its wakeup count and CPU load
+static const uint32_t STATS_REPORT_INTERVAL_MS = 10000;
 
 // TODO:
 //   - Determine optimal buffer sizes (dma included)
@@ -44,17 +48,81 @@ enum TaskNotificationBits : uint32_t {
   COMMAND_STOP = (1 << 1),   // stops the main task
 };
 
+static size_t dma_buffer_frames(uint32_t sample_rate) { return sample_rate * DMA_BUFFER_DURATION_MS / 1000; }
+
 void NabuMicrophoneChannel::setup() {
-  const size_t ring_buffer_size = RING_BUFFER_LENGTH * this->parent_->get_sample_rate() / 1000 * sizeof(int16_t);
-  this->ring_buffer_ = RingBuffer::create(ring_buffer_size);
+  const uint32_t capture_rate = this->parent_->get_sample_rate();
+  if (this->sample_rate_ == 0) {
+    this->sample_rate_ = capture_rate;
+  }
+
+  this->ring_buffer_ = SampleRingBuffer::create(RING_BUFFER_LENGTH * this->sample_rate_ / 1000);
   if (this->ring_buffer_ == nullptr) {
     ESP_LOGE(TAG, "Could not allocate ring buffer");
     this->mark_failed();
     return;
   }
+
+  if (this->has_span_callbacks_) {
+    this->callback_ring_buffer_ = SampleRingBuffer::create(RING_BUFFER_LENGTH * this->sample_rate_ / 1000);
+    if (this->callback_ring_buffer_ == nullptr) {
+      ESP_LOGE(TAG, "Could not allocate the callback ring buffer");
+      this->mark_failed();
+      return;
+    }
+  }
+
+  const size_t capture_frames = dma_buffer_frames(capture_rate);
+  const uint8_t factor = capture_rate / this->sample_rate_;
+
+  this->capture_samples_.resize(capture_frames);
+  this->output_samples_.resize(capture_frames / factor + 1);
+  if (!this->decimator_.init(factor, capture_frames)) {
+    ESP_LOGE(TAG, "Could not allocate the decimator");
+    this->mark_failed();
+    return;
+  }
+}
+
+void NabuMicrophoneChannel::process_capture(const int32_t *capture, size_t frames, size_t channels) {
+  if (this->is_muted_) {
+    // Write nothing, so consumers don't spend time processing silence
+    this->capture_muted_ = true;
+    return;
+  }
+  if (this->capture_muted_) {
+    // Don't filter the audio from before the mute into the first unmuted samples
+    this->decimator_.reset();
+    this->capture_muted_ = false;
+  }
+
+  const uint8_t shift = 16 - this->amplify_shift_;
+
+  const int32_t *source = capture + this->source_channel_;
+  for (size_t i = 0; i < frames; i++) {
+    this->capture_samples_[i] = (int16_t) clamp<int32_t>(source[channels * i] >> shift, INT16_MIN, INT16_MAX);
+  }
+
+  const size_t output_samples =
+      this->decimator_.process(this->capture_samples_.data(), frames, this->output_samples_.data());
+  this->ring_buffer_->write(this->output_samples_.data(), output_samples);
+  if (this->callback_ring_buffer_ != nullptr) {
+    this->callback_ring_buffer_->write(this->output_samples_.data(), output_samples);
+  }
 }
 
 void NabuMicrophoneChannel::loop() {
+  if (this->callback_ring_buffer_ != nullptr) {
+    // Lend everything in the callbacks' ring buffer to them, one contiguous run at a time
+    const size_t max_samples = RING_BUFFER_LENGTH * this->sample_rate_ / 1000;
+    microphone::SampleSpan span = this->callback_ring_buffer_->acquire(max_samples);
+    while (!span.empty()) {
+      this->span_callbacks_.call(span);
+      this->callback_ring_buffer_->release(span);
+      span = this->callback_ring_buffer_->acquire(max_samples);
+    }
+  }
+
   if (this->parent_->is_running()) {
     if (this->is_muted_) {
       if (this->requested_stop_) {
@@ -109,20 +177,14 @@ void NabuMicrophone::setup() {
 }
 
 void NabuMicrophone::mute() {
-  if (this->channel_0_ != nullptr) {
-    this->channel_0_->set_mute_state(true);
-  }
-  if (this->channel_1_ != nullptr) {
-    this->channel_1_->set_mute_state(true);
+  for (auto *channel : this->channels_) {
+    channel->set_mute_state(true);
   }
 }
 
 void NabuMicrophone::unmute() {
-  if (this->channel_0_ != nullptr) {
-    this->channel_0_->set_mute_state(false);
-  }
-  if (this->channel_1_ != nullptr) {
-    this->channel_1_->set_mute_state(false);
+  for (auto *channel : this->channels_) {
+    channel->set_mute_state(false);
   }
 }
 
@@ -141,7 +203,7 @@ esp_err_t NabuMicrophone::start_i2s_driver_() {
       .communication_format = I2S_COMM_FORMAT_STAND_I2S,
       .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
       .dma_buf_count = DMA_BUFFERS_COUNT,
-      .dma_buf_len = DMA_BUFFER_SIZE,
+      .dma_buf_len = (int) dma_buffer_frames(this->sample_rate_),
       .use_apll = this->use_apll_,
       .tx_desc_auto_clear = false,
       .fixed_mclk = 0,
@@ -160,18 +222,29 @@ esp_err_t NabuMicrophone::start_i2s_driver_() {
 #if SOC_I2S_SUPPORTS_ADC
   if (this->adc_) {
     config.mode = (i2s_mode_t) (config.mode | I2S_MODE_ADC_BUILT_IN);
-    i2s_driver_install(this->parent_->get_port(), &config, 0, nullptr);
+    err = i2s_driver_install(this->parent_->get_port(), &config, I2S_EVENT_QUEUE_LENGTH, &this->i2s_event_queue_);
+    if (err != ESP_OK) {
+      this->parent_->unlock();
+      return err;
+    }
 
-    i2s_set_adc_mode(ADC_UNIT_1, this->adc_channel_);
-    i2s_adc_enable(this->parent_->get_port());
+    err = i2s_set_adc_mode(ADC_UNIT_1, this->adc_channel_);
+    if (err == ESP_OK) {
+      err = i2s_adc_enable(this->parent_->get_port());
+    }
+    if (err != ESP_OK) {
+      this->stop_i2s_driver_();
+      return err;
+    }
   } else
 #endif
   {
     if (this->pdm_)
       config.mode = (i2s_mode_t) (config.mode | I2S_MODE_PDM);
 
-    err = i2s_driver_install(this->parent_->get_port(), &config, 0, nullptr);
+    err = i2s_driver_install(this->parent_->get_port(), &config, I2S_EVENT_QUEUE_LENGTH, &this->i2s_event_queue_);
     if (err != ESP_OK) {
+      this->parent_->unlock();
       return err;
     }
 
@@ -180,18 +253,49 @@ esp_err_t NabuMicrophone::start_i2s_driver_() {
 
     err = i2s_set_pin(this->parent_->get_port(), &pin_config);
     if (err != ESP_OK) {
+      this->stop_i2s_driver_();
       return err;
     }
   }
 
+  this->driver_installed_ = true;
   return ESP_OK;
 }
 
+void NabuMicrophone::stop_i2s_driver_() {
+  i2s_stop(this->parent_->get_port());
+  i2s_driver_uninstall(this->parent_->get_port());
+  this->i2s_event_queue_ = nullptr;  // Deleted by the driver
+  this->driver_installed_ = false;
+
+  this->parent_->unlock();
+}
+
+esp_err_t NabuMicrophone::resume_i2s_driver_() {
+  // The driver queues the buffers received before it was paused; drop them along with their events
+  int32_t discard[NUMBER_OF_CHANNELS * 16];
+  size_t bytes_read = 0;
+  do {
+    if (i2s_read(this->parent_->get_port(), discard, sizeof(discard), &bytes_read, 0) != ESP_OK) {
+      break;
+    }
+  } while (bytes_read > 0);
+  xQueueReset(this->i2s_event_queue_);
+
+  return i2s_start(this->parent_->get_port());
+}
+
 void NabuMicrophone::read_task_(void *params) {
   NabuMicrophone *this_microphone = (NabuMicrophone *) params;
   TaskEvent event;
   esp_err_t err;
 
+  // DMA buffers are read and processed one at a time, so the working buffer holds a single DMA buffer's worth of audio
+  // Note, if we have 16 bit samples incoming, this requires modification
+  const size_t samples_in_dma_buffer = dma_buffer_frames(this_microphone->sample_rate_) * NUMBER_OF_CHANNELS;
+  ExternalRAMAllocator<int32_t> allocator(ExternalRAMAllocator<int32_t>::ALLOW_FAILURE);
+  int32_t *buffer = nullptr;
+
   while (true) {
     uint32_t notification_bits = 0;
     xTaskNotifyWait(ULONG_MAX,           // clear all bits at start of wait
@@ -203,136 +307,157 @@ void NabuMicrophone::read_task_(void *params) {
       event.type = TaskEventType::STARTING;
       xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
 
-      if ((this_microphone->channel_0_ != nullptr) && this_microphone->channel_0_->is_failed()) {
-        event.type = TaskEventType::WARNING;
-        event.err = ESP_ERR_INVALID_STATE;
-        xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
-        continue;
+      bool channel_failed = false;
+      for (auto *channel : this_microphone->channels_) {
+        channel_failed |= channel->is_failed();
       }
-
-      if ((this_microphone->channel_1_ != nullptr) && this_microphone->channel_1_->is_failed()) {
+      if (channel_failed) {
         event.type = TaskEventType::WARNING;
         event.err = ESP_ERR_INVALID_STATE;
         xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
         continue;
       }
 
-      // Note, if we have 16 bit samples incoming, this requires modification
-      ExternalRAMAllocator<int32_t> allocator(ExternalRAMAllocator<int32_t>::ALLOW_FAILURE);
-      int32_t *buffer = allocator.allocate(SAMPLES_IN_ALL_DMA_BUFFERS);
-
-      std::vector<int16_t, ExternalRAMAllocator<int16_t>> channel_0_samples;
-      std::vector<int16_t, ExternalRAMAllocator<int16_t>> channel_1_samples;
-
-      size_t channel_0_reserved_samples = 0;
-      size_t channel_1_reserved_samples = 0;
-
-      if (this_microphone->channel_0_ != nullptr) {
-        channel_0_reserved_samples = FRAMES_IN_ALL_DMA_BUFFERS;
-        channel_0_samples.reserve(channel_0_reserved_samples);
-      }
-
-      if (this_microphone->channel_1_ != nullptr) {
-        channel_1_reserved_samples = FRAMES_IN_ALL_DMA_BUFFERS;
-        channel_1_samples.reserve(channel_1_reserved_samples);
+      if (buffer == nullptr) {
+        buffer = allocator.allocate(samples_in_dma_buffer);
       }
 
-      if ((buffer == nullptr) || (channel_0_samples.capacity() < channel_0_reserved_samples) ||
-          (channel_1_samples.capacity() < channel_1_reserved_samples)) {
+      if (buffer == nullptr) {
         event.type = TaskEventType::WARNING;
         event.err = ESP_ERR_NO_MEM;
         xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
       } else {
-        err = this_microphone->start_i2s_driver_();
+        if (this_microphone->driver_installed_) {
+          err = this_microphone->resume_i2s_driver_();
+        } else {
+          err = this_microphone->start_i2s_driver_();
+        }
         if (err != ESP_OK) {
           event.type = TaskEventType::WARNING;
           event.err = err;
           xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
         } else {
           // TODO: Is this the ideal spot to reset the ring buffers?
-          if (this_microphone->channel_0_ != nullptr)
-            this_microphone->channel_0_->get_ring_buffer()->reset();
-          if (this_microphone->channel_1_ != nullptr)
-            this_microphone->channel_1_->get_ring_buffer()->reset();
+          for (auto *channel : this_microphone->channels_) {
+            channel->reset();
+            channel->reset_capture();
+          }
 
           event.type = TaskEventType::STARTED;
           xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
 
+          // Events are only sent when the state changes; a warning is cleared by the next successful read
+          bool warning_reported = false;
+          bool first_samples_written = false;
+
+          uint32_t stats_wakeups = 0;
+          uint32_t stats_dma_buffers = 0;
+          uint32_t stats_processing_us = 0;
+          uint32_t stats_last_report_ms = millis();
+
           while (true) {
             notification_bits = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(0));
             if (notification_bits & TaskNotificationBits::COMMAND_STOP) {
               break;
             }
 
-            size_t bytes_read;
-            esp_err_t err =
-                i2s_read(this_microphone->parent_->get_port(), buffer, SAMPLES_IN_ALL_DMA_BUFFERS * sizeof(int32_t),
-                         &bytes_read, pdMS_TO_TICKS(TASK_DELAY_MS));
-            if (err != ESP_OK) {
-              event.type = TaskEventType::WARNING;
-              event.err = err;
-              xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
+            // Sleep until the DMA interrupt reports a received buffer
+            i2s_event_t i2s_event;
+            if (xQueueReceive(this_microphone->i2s_event_queue_, &i2s_event, pdMS_TO_TICKS(DMA_TIMEOUT_MS)) !=
+                pdTRUE) {
+              if (!warning_reported) {
+                event.type = TaskEventType::WARNING;
+                event.err = ESP_ERR_TIMEOUT;
+                xQueueSend(this_microphone->event_queue_, &event, 0);
+                warning_reported = true;
+              }
+              continue;
             }
+            ++stats_wakeups;
+
+            // Both received and overflow events mean buffers are waiting, and a late wakeup may find several of them;
+            // drain every completed DMA buffer now rather than leaving the rest to events that may have been dropped
+            const uint32_t processing_start_us = micros();
+
+            while (true) {
+              size_t bytes_read = 0;
+              err = i2s_read(this_microphone->parent_->get_port(), buffer, samples_in_dma_buffer * sizeof(int32_t),
+                             &bytes_read, 0);
+              if (err != ESP_OK) {
+                if (!warning_reported) {
+                  event.type = TaskEventType::WARNING;
+                  event.err = err;
+                  xQueueSend(this_microphone->event_queue_, &event, 0);
+                  warning_reported = true;
+                }
+                break;
+              }
+
+              if (bytes_read == 0) {
+                break;
+              }
+
+              ++stats_dma_buffers;
 
-            if (bytes_read > 0) {
               // TODO: Handle 16 bits per sample, currently it won't allow that option at codegen stage
 
               const size_t samples_read = bytes_read / sizeof(int32_t);
               const size_t frames_read =
                   samples_read / NUMBER_OF_CHANNELS;  // Left and right channel samples combine into 1 frame
 
-              uint8_t channel_0_shift = 16;
-              if (this_microphone->channel_0_ != nullptr) {
-                channel_0_shift -= this_microphone->channel_0_->get_amplify_shift();
-              }
-              uint8_t channel_1_shift = 16;
-              if (this_microphone->channel_1_ != nullptr) {
-                channel_1_shift -= this_microphone->channel_1_->get_amplify_shift();
+              for (auto *channel : this_microphone->channels_) {
+                channel->process_capture(buffer, frames_read, NUMBER_OF_CHANNELS);
               }
 
-              for (size_t i = 0; i < frames_read; i++) {
-                int32_t channel_0_sample = 0;
-                if ((this_microphone->channel_0_ != nullptr) && (!this_microphone->channel_0_->get_mute_state())) {
-                  channel_0_sample = buffer[NUMBER_OF_CHANNELS * i] >> channel_0_shift;
-                  channel_0_samples[i] = (int16_t) clamp<int32_t>(channel_0_sample, INT16_MIN, INT16_MAX);
-                }
-
-                int32_t channel_1_sample = 0;
-                if ((this_microphone->channel_1_ != nullptr) && (!this_microphone->channel_1_->get_mute_state())) {
-                  channel_1_sample = buffer[NUMBER_OF_CHANNELS * i + 1] >> channel_1_shift;
-                  channel_1_samples[i] = (int16_t) clamp<int32_t>(channel_1_sample, INT16_MIN, INT16_MAX);
-                }
+              if (!first_samples_written) {
+                ESP_LOGD(TAG, "First samples available %" PRIu32 " us after starting (driver %s)",
+                         micros() - this_microphone->start_requested_us_,
+                         this_microphone->keep_driver_installed_ ? "resident" : "installed");
+                first_samples_written = true;
               }
 
-              size_t bytes_to_write = frames_read * sizeof(int16_t);
-
-              if (this_microphone->channel_0_ != nullptr) {
-                this_microphone->channel_0_->get_ring_buffer()->write((void *) channel_0_samples.data(),
-                                                                      bytes_to_write);
-              }
-              if (this_microphone->channel_1_ != nullptr) {
-                this_microphone->channel_1_->get_ring_buffer()->write((void *) channel_1_samples.data(),
-                                                                      bytes_to_write);
+              if (warning_reported) {
+                event.type = TaskEventType::RUNNING;
+                xQueueSend(this_microphone->event_queue_, &event, 0);
+                warning_reported = false;
               }
             }
 
-            event.type = TaskEventType::RUNNING;
-            xQueueSend(this_microphone->event_queue_, &event, 0);
+            stats_processing_us += micros() - processing_start_us;
+
+            const uint32_t stats_elapsed_ms = millis() - stats_last_report_ms;
+            if (stats_elapsed_ms > STATS_REPORT_INTERVAL_MS) {
+              ESP_LOGV(TAG,
+                       "%" PRIu32 " wakeups for %" PRIu32 " DMA buffers in %" PRIu32 " ms; processing used %" PRIu32
+                       " us (%.2f%% CPU)",
+                       stats_wakeups, stats_dma_buffers, stats_elapsed_ms, stats_processing_us,
+                       stats_processing_us / (stats_elapsed_ms * 10.0f));
+              stats_wakeups = 0;
+              stats_dma_buffers = 0;
+              stats_processing_us = 0;
+              stats_last_report_ms = millis();
+            }
           }
 
           event.type = TaskEventType::STOPPING;
           xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
 
-          allocator.deallocate(buffer, SAMPLES_IN_ALL_DMA_BUFFERS);
-          i2s_stop(this_microphone->parent_->get_port());
-          i2s_driver_uninstall(this_microphone->parent_->get_port());
-
-          this_microphone->parent_->unlock();
+          if (this_microphone->keep_driver_installed_) {
+            // Pause the DMA but keep the driver and its buffers for the next start
+            i2s_stop(this_microphone->parent_->get_port());
+          } else {
+            this_microphone->stop_i2s_driver_();
+          }
 
           event.type = TaskEventType::STOPPED;
           xQueueSend(this_microphone->event_queue_, &event, portMAX_DELAY);
         }
       }
+
+      if ((buffer != nullptr) && !this_microphone->keep_driver_installed_) {
+        allocator.deallocate(buffer, samples_in_dma_buffer);
+        buffer = nullptr;
+      }
     }
     event.type = TaskEventType::STOPPED;
     event.err = ESP_OK;
@@ -350,6 +475,8 @@ void NabuMicrophone::start() {
     xTaskCreate(NabuMicrophone::read_task_, "microphone_task", 3584, (void *) this, 23, &this->read_task_handle_);
   }
 
+  this->start_requested_us_ = micros();
+
   // TODO: Should we overwrite? If stop and start are called in quick succession, what behavior do we want
   xTaskNotify(this->read_task_handle_, TaskNotificationBits::COMMAND_START, eSetValueWithoutOverwrite);
 }
@@ -362,9 +489,12 @@ void NabuMicrophone::stop() {
 }
 
 void NabuMicrophone::loop() {
-  if ((this->channel_0_ != nullptr) && (this->channel_0_->get_requested_stop()) && (this->channel_1_ != nullptr) &&
-      (this->channel_1_->get_requested_stop())) {
-    // Both microphone channels have requested a stop
+  bool all_requested_stop = !this->channels_.empty();
+  for (auto *channel : this->channels_) {
+    all_requested_stop &= channel->get_requested_stop();
+  }
+  if (all_requested_stop) {
+    // Every microphone output has requested a stop
     this->stop();
   }
 
@@ -381,6 +511,7 @@ void NabuMicrophone::loop() {
         ESP_LOGD(TAG, "Started I2S Audio Microphone");
         break;
       case TaskEventType::RUNNING:
+        // Only sent when reads recover after a warning
         this->state_ = microphone::STATE_RUNNING;
         this->status_clear_warning();
         break;
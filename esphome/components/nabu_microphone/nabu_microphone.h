@@ -5,10 +5,12 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 
+#include "polyphase_decimator.h"
+#include "sample_ring_buffer.h"
+
 #include "esphome/components/i2s_audio/i2s_audio.h"
 #include "esphome/components/microphone/microphone.h"
 #include "esphome/core/component.h"
-#include "esphome/core/ring_buffer.h"
 
 namespace esphome {
 namespace nabu_microphone {
@@ -42,11 +44,8 @@ class NabuMicrophone : public i2s_audio::I2SAudioIn, public Component {
   void mute();
   void unmute();
 
-  void set_channel_0(NabuMicrophoneChannel *microphone) { this->channel_0_ = microphone; }
-  void set_channel_1(NabuMicrophoneChannel *microphone) { this->channel_1_ = microphone; }
-
-  NabuMicrophoneChannel *get_channel_0() { return this->channel_0_; }
-  NabuMicrophoneChannel *get_channel_1() { return this->channel_1_; }
+  /// @brief Adds an output. Several outputs can share a captured channel, each at its own sample rate.
+  void add_channel(NabuMicrophoneChannel *microphone) { this->channels_.push_back(microphone); }
 
 #if SOC_I2S_SUPPORTS_ADC
   void set_adc_channel(adc1_channel_t channel) {
@@ -63,11 +62,19 @@ class NabuMicrophone : public i2s_audio::I2SAudioIn, public Component {
   void set_din_pin(int8_t pin) { this->din_pin_ = pin; }
   void set_pdm(bool pdm) { this->pdm_ = pdm; }
 
+  /// @brief Keeps the I2S driver and its DMA buffers installed after the first start. Stopping then only pauses the
+  /// DMA, so a restart delivers samples after a single DMA period. The I2S bus stays locked by the microphone.
+  void set_keep_driver_installed(bool keep_driver_installed) { this->keep_driver_installed_ = keep_driver_installed; }
+
   bool is_running() { return this->state_ == microphone::STATE_RUNNING; }
   uint32_t get_sample_rate() { return this->sample_rate_; }
 
  protected:
   esp_err_t start_i2s_driver_();
+  void stop_i2s_driver_();
+
+  /// @brief Restarts the DMA of an installed driver and discards any audio captured before it was paused
+  esp_err_t resume_i2s_driver_();
 
   microphone::State state_{microphone::STATE_STOPPED};
 
@@ -76,11 +83,18 @@ class NabuMicrophone : public i2s_audio::I2SAudioIn, public Component {
   TaskHandle_t read_task_handle_{nullptr};
   QueueHandle_t event_queue_;
 
-  NabuMicrophoneChannel *channel_0_{nullptr};
-  NabuMicrophoneChannel *channel_1_{nullptr};
+  // Created by the I2S driver; receives an event from the DMA interrupt for every completed receive buffer
+  QueueHandle_t i2s_event_queue_{nullptr};
+
+  // Time start() was called; the read task logs how long the first samples took to arrive
+  uint32_t start_requested_us_{0};
+
+  std::vector<NabuMicrophoneChannel *> channels_;
 
   bool use_apll_;
   bool pdm_{false};
+  bool keep_driver_installed_{false};
+  bool driver_installed_{false};  // Only modified by the read task
   int8_t din_pin_{I2S_PIN_NO_CHANGE};
 
 #if SOC_I2S_SUPPORTS_ADC
@@ -91,7 +105,7 @@ class NabuMicrophone : public i2s_audio::I2SAudioIn, public Component {
   i2s_bits_per_sample_t bits_per_sample_;
   i2s_channel_fmt_t channel_;
   i2s_mode_t i2s_mode_{};
-  uint32_t sample_rate_;
+  uint32_t sample_rate_;  // Capture rate; each output decimates it to its own rate
 };
 
 class NabuMicrophoneChannel : public microphone::Microphone, public Component {
@@ -100,7 +114,7 @@ class NabuMicrophoneChannel : public microphone::Microphone, public Component {
 
   void start() override {
     this->parent_->start();
-    this->is_muted_ = false;
+    this->is_muted_ = this->mute_requested_;
     this->requested_stop_ = false;
   }
 
@@ -113,30 +127,75 @@ class NabuMicrophoneChannel : public microphone::Microphone, public Component {
 
   void loop() override;
 
-  void set_mute_state(bool mute_state) override { this->is_muted_ = mute_state; }
-  bool get_mute_state() { return this->is_muted_; }
+  /// @brief Mutes or unmutes the output. The mute state persists across restarts. While muted, nothing is written
+  /// to the ring buffer.
+  void set_mute_state(bool mute_state) override {
+    this->mute_requested_ = mute_state;
+    if (!this->requested_stop_) {
+      this->is_muted_ = mute_state;
+    }
+  }
+  bool get_mute_state() override { return this->is_muted_; }
 
   // void set_requested_stop() { this->requested_stop_ = true; }
   bool get_requested_stop() { return this->requested_stop_; }
 
+  // Readers (read/acquire) and span/data callbacks each get every sample. The read task writes the output to the
+  // readers' ring buffer and, if any callbacks were added before setup, to a separate one that loop() drains into the
+  // callbacks, so neither consumer takes audio from the other.
   size_t read(int16_t *buf, size_t len, TickType_t ticks_to_wait = 0) override {
     return this->ring_buffer_->read((void *) buf, len, ticks_to_wait);
   };
   size_t read(int16_t *buf, size_t len) override { return this->ring_buffer_->read((void *) buf, len); };
+  microphone::SampleSpan acquire(size_t max_samples, TickType_t ticks_to_wait) override {
+    return this->ring_buffer_->acquire(max_samples, ticks_to_wait);
+  }
+  void release(microphone::SampleSpan span) override { this->ring_buffer_->release(span); }
   void reset() override { this->ring_buffer_->reset(); }
 
-  RingBuffer *get_ring_buffer() { return this->ring_buffer_.get(); }
-
   void set_amplify_shift(uint8_t amplify_shift) { this->amplify_shift_ = amplify_shift; }
   uint8_t get_amplify_shift() { return this->amplify_shift_; }
 
+  /// @brief Selects which captured channel (0 or 1) this output reads
+  void set_source_channel(uint8_t source_channel) { this->source_channel_ = source_channel; }
+  uint8_t get_source_channel() { return this->source_channel_; }
+
+  /// @brief Sets the output sample rate; the capture rate must be a multiple of it
+  void set_sample_rate(uint32_t sample_rate) { this->sample_rate_ = sample_rate; }
+  uint32_t get_sample_rate() { return this->sample_rate_; }
+
+  /// @brief Called by the read task. Converts this output's channel from a block of captured frames, decimates it to
+  /// the output rate, and writes it to the ring buffer. Does nothing while muted.
+  /// @param capture Interleaved 32 bit samples
+  /// @param frames Number of frames in the block
+  /// @param channels Number of interleaved channels in the capture
+  void process_capture(const int32_t *capture, size_t frames, size_t channels);
+
+  /// @brief Clears the decimator's history and the callbacks' buffer so a restarted capture doesn't include stale
+  /// audio
+  void reset_capture() {
+    this->decimator_.reset();
+    if (this->callback_ring_buffer_ != nullptr) {
+      this->callback_ring_buffer_->reset();
+    }
+  }
+
  protected:
   NabuMicrophone *parent_;
-  std::unique_ptr<RingBuffer> ring_buffer_;
+  std::unique_ptr<SampleRingBuffer> ring_buffer_;           // Consumed by read and acquire
+  std::unique_ptr<SampleRingBuffer> callback_ring_buffer_;  // Consumed by loop() for the span callbacks
+
+  PolyphaseDecimator decimator_;
+  std::vector<int16_t> capture_samples_;  // This output's channel at the capture rate
+  std::vector<int16_t> output_samples_;   // Decimated to the output rate
 
+  uint8_t source_channel_{0};
+  uint32_t sample_rate_{0};  // 0 uses the capture rate
   uint8_t amplify_shift_;
   bool is_muted_;
+  bool mute_requested_{false};  // Mute state set by set_mute_state; stopping mutes temporarily
   bool requested_stop_;
+  bool capture_muted_{false};  // Only accessed by the read task
 };
 
 }  // namespace nabu_microphone
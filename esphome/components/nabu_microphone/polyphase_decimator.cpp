@@ -0,0 +1,120 @@
+#include "polyphase_decimator.h"
+
+#ifdef USE_ESP32
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace nabu_microphone {
+
+static const float CUTOFF_RATIO = 0.9f;  // Relative to the output Nyquist frequency
+static const float KAISER_BETA = 5.65f;  // Kaiser window shape for about 60 dB of stopband attenuation
+
+// Zeroth order modified Bessel function of the first kind, summed as a power series
+static float bessel_i0(float x) {
+  float sum = 1.0f;
+  float term = 1.0f;
+  for (uint8_t k = 1; term > 1e-7f * sum; ++k) {
+    const float ratio = x / (2.0f * k);
+    term *= ratio * ratio;
+    sum += term;
+  }
+  return sum;
+}
+
+bool PolyphaseDecimator::init(uint8_t factor, size_t max_input_samples) {
+  this->factor_ = factor;
+  this->next_output_offset_ = 0;
+
+  if (factor <= 1) {
+    this->factor_ = 1;
+    this->taps_ = 1;
+    return true;
+  }
+
+  // An odd number of taps gives the filter an integer group delay
+  this->taps_ = TAPS_PER_FACTOR * factor + 1;
+
+  this->coefficients_.resize(this->taps_);
+  this->window_.resize(this->taps_ - 1 + max_input_samples);
+  if ((this->coefficients_.size() < this->taps_) || (this->window_.size() < this->taps_ - 1 + max_input_samples)) {
+    return false;
+  }
+
+  const float cutoff = CUTOFF_RATIO * 0.5f / factor;  // Cycles per input sample
+  const float center = (this->taps_ - 1) / 2.0f;
+
+  std::vector<float> design(this->taps_);
+  const float window_scale = 1.0f / bessel_i0(KAISER_BETA);
+  float sum = 0.0f;
+  for (size_t i = 0; i < this->taps_; ++i) {
+    const float t = i - center;
+    float sinc = (t == 0.0f) ? 2.0f * cutoff : sinf(2.0f * M_PI * cutoff * t) / (M_PI * t);
+    const float r = t / center;
+    float window = bessel_i0(KAISER_BETA * sqrtf(std::max(0.0f, 1.0f - r * r))) * window_scale;
+    design[i] = sinc * window;
+    sum += design[i];
+  }
+
+  // Normalize to unity gain at DC
+  for (size_t i = 0; i < this->taps_; ++i) {
+    this->coefficients_[i] = static_cast<int16_t>(lroundf(design[i] / sum * 32768.0f));
+  }
+
+  this->reset();
+  return true;
+}
+
+void PolyphaseDecimator::reset() {
+  std::fill(this->window_.begin(), this->window_.end(), 0);
+  this->next_output_offset_ = 0;
+}
+
+size_t PolyphaseDecimator::process(const int16_t *input, size_t input_samples, int16_t *output) {
+  if (this->factor_ == 1) {
+    memcpy(output, input, input_samples * sizeof(int16_t));
+    return input_samples;
+  }
+
+  const size_t history = this->taps_ - 1;
+  int16_t *window = this->window_.data();
+  memcpy(window + history, input, input_samples * sizeof(int16_t));
+
+  const int16_t *coefficients = this->coefficients_.data();
+  const size_t half_taps = this->taps_ / 2;
+
+  size_t outputs = 0;
+  size_t offset = this->next_output_offset_;
+  for (; offset < input_samples; offset += this->factor_) {
+    // The output for input sample ``offset`` uses it and the ``history`` samples before it
+    const int16_t *oldest = window + offset;
+    const int16_t *newest = oldest + history;
+
+    int32_t accumulator = static_cast<int32_t>(coefficients[half_taps]) * oldest[half_taps];
+    for (size_t k = 0; k < half_taps; ++k) {
+      accumulator += static_cast<int32_t>(coefficients[k]) * (oldest[k] + newest[-static_cast<ptrdiff_t>(k)]);
+    }
+
+    // Round from Q15 and saturate
+    accumulator = (accumulator + (1 << 14)) >> 15;
+    if (accumulator > INT16_MAX) {
+      accumulator = INT16_MAX;
+    } else if (accumulator < INT16_MIN) {
+      accumulator = INT16_MIN;
+    }
+    output[outputs++] = static_cast<int16_t>(accumulator);
+  }
+  this->next_output_offset_ = offset - input_samples;
+
+  // Keep the newest samples as history for the next block
+  memmove(window, window + input_samples, history * sizeof(int16_t));
+
+  return outputs;
+}
+
+}  // namespace nabu_microphone
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace nabu_microphone {
+
+// Reduces the sample rate by an integer factor with a linear phase FIR low pass filter
+//  - Only every ``factor``-th output of the filter is computed, which is the polyphase form of decimation: each output
+//    costs ``TAPS_PER_FACTOR`` multiplies per unit of factor instead of a full filter per input sample
+//  - The filter is symmetric, so pairs of input samples sharing a coefficient are added before multiplying
+//  - The coefficients are a Kaiser windowed sinc (beta 5.65) with its cutoff at 90% of the output Nyquist frequency.
+//    Anything that would alias into the passband is attenuated by at least 60 dB.
+//  - A factor of 1 copies the input unchanged
+//  - State carries over between calls, so a stream can be processed in blocks of any size
+
+class PolyphaseDecimator {
+ public:
+  /// @brief Designs the filter and allocates its history
+  /// @param factor Ratio of the input to the output sample rate
+  /// @param max_input_samples Largest block passed to `process`
+  /// @return True if successful, false if the buffers couldn't be allocated
+  bool init(uint8_t factor, size_t max_input_samples);
+
+  /// @brief Filters and decimates a block of samples
+  /// @param input Samples at the input rate
+  /// @param input_samples Number of input samples; must not exceed the `max_input_samples` passed to `init`
+  /// @param output Buffer for the decimated samples. Must hold at least `input_samples / factor + 1` samples.
+  /// @return Number of samples written to the output
+  size_t process(const int16_t *input, size_t input_samples, int16_t *output);
+
+  /// @brief Clears the filter history, e.g., when the stream restarts
+  void reset();
+
+  uint8_t get_factor() const { return this->factor_; }
+
+  static const uint8_t TAPS_PER_FACTOR = 32;
+
+ protected:
+  uint8_t factor_{1};
+  size_t taps_{1};
+
+  // Index of the next input sample (relative to the start of the next block) that produces an output
+  size_t next_output_offset_{0};
+
+  std::vector<int16_t> coefficients_;  // Q15
+  // The last ``taps_ - 1`` samples of the previous block followed by the current block
+  std::vector<int16_t> window_;
+};
+
+}  // namespace nabu_microphone
+}  // namespace esphome
+
+#endif
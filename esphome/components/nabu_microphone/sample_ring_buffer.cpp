@@ -0,0 +1,115 @@
+#include "sample_ring_buffer.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/helpers.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace nabu_microphone {
+
+SampleRingBuffer::~SampleRingBuffer() {
+  if (this->handle_ != nullptr) {
+    vRingbufferDelete(this->handle_);
+    ExternalRAMAllocator<uint8_t> allocator(ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE);
+    allocator.deallocate(this->storage_, this->size_);
+  }
+}
+
+std::unique_ptr<SampleRingBuffer> SampleRingBuffer::create(size_t samples) {
+  std::unique_ptr<SampleRingBuffer> ring_buffer = make_unique<SampleRingBuffer>();
+
+  ring_buffer->size_ = samples * sizeof(int16_t);
+
+  ExternalRAMAllocator<uint8_t> allocator(ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE);
+  ring_buffer->storage_ = allocator.allocate(ring_buffer->size_);
+  if (ring_buffer->storage_ == nullptr) {
+    return nullptr;
+  }
+
+  ring_buffer->handle_ =
+      xRingbufferCreateStatic(ring_buffer->size_, RINGBUF_TYPE_BYTEBUF, ring_buffer->storage_, &ring_buffer->structure_);
+  if (ring_buffer->handle_ == nullptr) {
+    allocator.deallocate(ring_buffer->storage_, ring_buffer->size_);
+    return nullptr;
+  }
+
+  return ring_buffer;
+}
+
+size_t SampleRingBuffer::write(const int16_t *samples, size_t count) {
+  const size_t bytes = count * sizeof(int16_t);
+
+  const size_t free = xRingbufferGetCurFreeSize(this->handle_);
+  if (free < bytes) {
+    this->discard_bytes_(bytes - free);
+  }
+
+  if (xRingbufferSend(this->handle_, samples, bytes, 0) != pdTRUE) {
+    return 0;
+  }
+  return count;
+}
+
+size_t SampleRingBuffer::read(void *data, size_t len, TickType_t ticks_to_wait) {
+  size_t bytes_read = 0;
+
+  void *buffer_data = xRingbufferReceiveUpTo(this->handle_, &bytes_read, ticks_to_wait, len);
+  if (buffer_data == nullptr) {
+    return 0;
+  }
+  std::memcpy(data, buffer_data, bytes_read);
+  vRingbufferReturnItem(this->handle_, buffer_data);
+
+  if (bytes_read < len) {
+    // The data may have wrapped around the end of the storage, so receive the rest without waiting
+    size_t wrapped_bytes_read = 0;
+    buffer_data = xRingbufferReceiveUpTo(this->handle_, &wrapped_bytes_read, 0, len - bytes_read);
+    if (buffer_data != nullptr) {
+      std::memcpy(static_cast<uint8_t *>(data) + bytes_read, buffer_data, wrapped_bytes_read);
+      vRingbufferReturnItem(this->handle_, buffer_data);
+      bytes_read += wrapped_bytes_read;
+    }
+  }
+
+  return bytes_read;
+}
+
+microphone::SampleSpan SampleRingBuffer::acquire(size_t max_samples, TickType_t ticks_to_wait) {
+  size_t bytes_received = 0;
+  void *buffer_data = xRingbufferReceiveUpTo(this->handle_, &bytes_received, ticks_to_wait,
+                                             max_samples * sizeof(int16_t));
+  if (buffer_data == nullptr) {
+    return {};
+  }
+  // Writes are whole samples and the storage size is even, so a span never splits a sample
+  return microphone::SampleSpan{static_cast<const int16_t *>(buffer_data), bytes_received / sizeof(int16_t)};
+}
+
+void SampleRingBuffer::release(microphone::SampleSpan span) {
+  if (span.data != nullptr) {
+    vRingbufferReturnItem(this->handle_, const_cast<int16_t *>(span.data));
+  }
+}
+
+void SampleRingBuffer::reset() { this->discard_bytes_(this->size_); }
+
+size_t SampleRingBuffer::discard_bytes_(size_t bytes) {
+  size_t discarded = 0;
+  while (discarded < bytes) {
+    size_t bytes_received = 0;
+    void *buffer_data = xRingbufferReceiveUpTo(this->handle_, &bytes_received, 0, bytes - discarded);
+    if (buffer_data == nullptr) {
+      break;
+    }
+    vRingbufferReturnItem(this->handle_, buffer_data);
+    discarded += bytes_received;
+  }
+  return discarded;
+}
+
+}  // namespace nabu_microphone
+}  // namespace esphome
+
+#endif
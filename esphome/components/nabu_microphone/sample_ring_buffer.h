@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "esphome/components/microphone/microphone.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace nabu_microphone {
+
+// Ring buffer of 16 bit samples that can lend its contents to a reader without copying
+//  - Like the core ``RingBuffer``, it wraps a FreeRTOS byte buffer, and a write that doesn't fit discards the oldest
+//    samples. It also exposes the byte buffer's zero copy receive through ``acquire`` and ``release``.
+//  - Only one span may be acquired at a time. While a reader holds one, nothing can be discarded, so a write that
+//    doesn't fit in the free space is dropped.
+//  - A span ends at the end of the storage, so a read across the wrap point takes two acquires
+
+class SampleRingBuffer {
+ public:
+  ~SampleRingBuffer();
+
+  /// @brief Allocates a ring buffer, preferring external RAM
+  /// @param samples Capacity in samples
+  /// @return The ring buffer, or nullptr if it couldn't be allocated
+  static std::unique_ptr<SampleRingBuffer> create(size_t samples);
+
+  /// @brief Writes samples, discarding the oldest ones if there isn't enough space
+  /// @return Number of samples written
+  size_t write(const int16_t *samples, size_t count);
+
+  /// @brief Copies up to len bytes into data, waiting up to ticks_to_wait for the first ones
+  /// @return Number of bytes read
+  size_t read(void *data, size_t len, TickType_t ticks_to_wait = 0);
+
+  /// @brief Borrows up to max_samples, waiting up to ticks_to_wait for any to arrive
+  /// @return The samples; empty if none arrived in time or if a span is already acquired
+  microphone::SampleSpan acquire(size_t max_samples, TickType_t ticks_to_wait = 0);
+
+  /// @brief Returns a span from acquire()
+  void release(microphone::SampleSpan span);
+
+  /// @brief Discards every stored sample. Samples in an acquired span stay valid until it is released.
+  void reset();
+
+ protected:
+  /// @brief Receives and returns up to bytes bytes
+  /// @return Number of bytes discarded
+  size_t discard_bytes_(size_t bytes);
+
+  RingbufHandle_t handle_{nullptr};
+  StaticRingbuffer_t structure_;
+  uint8_t *storage_{nullptr};
+  size_t size_{0};  // In bytes
+};
+
+}  // namespace nabu_microphone
+}  // namespace esphome
+
+#endif
@@ -11,6 +11,7 @@ from esphome.const import (
     CONF_ON_IDLE,
 )
 from esphome import automation
+import esphome.final_validate as fv
 from esphome.automation import register_action, register_condition
 from esphome.components import microphone, micro_wake_word, speaker, media_player
 
@@ -85,6 +86,30 @@ def tts_stream_validate(config):
     return config
 
 
+def vad_threshold_validate(config):
+    # Speech is detected using the VAD model that micro_wake_word already runs
+    if CONF_VAD_THRESHOLD in config and CONF_MICRO_WAKE_WORD not in config:
+        raise cv.Invalid(
+            f"{CONF_MICRO_WAKE_WORD} with a VAD model is required when using {CONF_VAD_THRESHOLD}"
+        )
+    return config
+
+
+def _final_validate_vad_model(config):
+    # The referenced micro_wake_word component only runs a VAD model if its configuration has one
+    if CONF_VAD_THRESHOLD not in config:
+        return config
+
+    full_config = fv.full_config.get()
+    mww_path = full_config.get_path_for_id(config[CONF_MICRO_WAKE_WORD])[:-1]
+    mww_config = full_config.get_config_for_path(mww_path)
+    if micro_wake_word.CONF_VAD not in mww_config:
+        raise cv.Invalid(
+            f"{CONF_VAD_THRESHOLD} requires the {CONF_MICRO_WAKE_WORD} component to have a {micro_wake_word.CONF_VAD} model"
+        )
+    return config
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
@@ -96,9 +121,7 @@ CONFIG_SCHEMA = cv.All(
             ),
             cv.Optional(CONF_MICRO_WAKE_WORD): cv.use_id(micro_wake_word.MicroWakeWord),
             cv.Optional(CONF_USE_WAKE_WORD, default=False): cv.boolean,
-            cv.Optional(CONF_VAD_THRESHOLD): cv.All(
-                cv.requires_component("esp_adf"), cv.only_with_esp_idf, cv.uint8_t
-            ),
+            cv.Optional(CONF_VAD_THRESHOLD): cv.uint8_t,
             cv.Optional(CONF_NOISE_SUPPRESSION_LEVEL, default=0): cv.int_range(0, 4),
             cv.Optional(CONF_AUTO_GAIN, default="0dBFS"): cv.All(
                 cv.float_with_unit("decibel full scale", "(dBFS|dbfs|DBFS)"),
@@ -160,8 +183,11 @@ CONFIG_SCHEMA = cv.All(
         }
     ).extend(cv.COMPONENT_SCHEMA),
     tts_stream_validate,
+    vad_threshold_validate,
 )
 
+FINAL_VALIDATE_SCHEMA = _final_validate_vad_model
+
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
@@ -336,7 +362,12 @@ async def to_code(config):
     if on_timer_tick := config.get(CONF_ON_TIMER_TICK):
         await automation.build_automation(
             var.get_timer_tick_trigger(),
-            [(cg.std_vector.template(Timer), "timers")],
+            [
+                (
+                    cg.std_vector.template(Timer).operator("ref").operator("const"),
+                    "timers",
+                )
+            ],
             on_timer_tick,
         )
         has_timers = True
@@ -6,6 +6,11 @@
 
 #include <cinttypes>
 #include <cstdio>
+#include <utility>
+
+#ifdef USE_SPEAKER
+#include <sys/select.h>
+#endif
 
 namespace esphome {
 namespace voice_assistant {
@@ -25,8 +30,26 @@ static const size_t SEND_BUFFER_SIZE = INPUT_BUFFER_SIZE * sizeof(int16_t);
 static const size_t RECEIVE_SIZE = 1024;
 static const size_t SPEAKER_BUFFER_SIZE = 16 * RECEIVE_SIZE;
 
+#ifdef USE_SPEAKER
+// Buffers TTS audio received over UDP between the receive task and the main loop
+static const size_t UDP_AUDIO_BUFFER_SIZE = 32 * RECEIVE_SIZE;
+static const uint32_t UDP_RECEIVE_TASK_STACK_SIZE = 3072;
+static const UBaseType_t UDP_RECEIVE_TASK_PRIORITY = 5;
+// While a pipeline runs, the receive task blocks in select() until a datagram arrives. The timeout only bounds how
+// long it takes to notice the pipeline went idle; while idle, it sleeps until set_state_ notifies it.
+static const uint32_t UDP_RECEIVE_TIMEOUT_MS = 100;
+#endif
+
+#ifdef USE_MICRO_WAKE_WORD_VAD
+// Each step of the VAD threshold; the frame length of the previous esp_vad based detection
+static const uint32_t VAD_FRAME_MS = 30;
+// If micro_wake_word hasn't updated its VAD state for this long, the state is stale
+static const uint32_t VAD_STALE_MS = 500;
+#endif
+
 VoiceAssistant::VoiceAssistant() {
   global_voice_assistant = this;
+  this->timers_.reserve(MAX_TIMERS);
 }
 
 float VoiceAssistant::get_setup_priority() const { return setup_priority::AFTER_CONNECTION; }
@@ -68,6 +91,27 @@ bool VoiceAssistant::start_udp_socket_() {
       this->mark_failed();
       return false;
     }
+
+    if (this->socket_->get_fd() < 0) {
+      ESP_LOGE(TAG, "Socket has no file descriptor to wait on");
+      this->mark_failed();
+      return false;
+    }
+
+    // The socket is never closed, so the buffer and receive task live as long as the component
+    this->udp_audio_buffer_ = RingBuffer::create(UDP_AUDIO_BUFFER_SIZE);
+    if (this->udp_audio_buffer_ == nullptr) {
+      ESP_LOGE(TAG, "Could not allocate UDP audio buffer");
+      this->mark_failed();
+      return false;
+    }
+    xTaskCreate(VoiceAssistant::udp_receive_task_, "va_udp_receive", UDP_RECEIVE_TASK_STACK_SIZE, (void *) this,
+                UDP_RECEIVE_TASK_PRIORITY, &this->udp_receive_task_handle_);
+    if (this->udp_receive_task_handle_ == nullptr) {
+      ESP_LOGE(TAG, "Could not create UDP receive task");
+      this->mark_failed();
+      return false;
+    }
   }
 #endif
   this->udp_socket_running_ = true;
@@ -97,10 +141,6 @@ bool VoiceAssistant::allocate_buffers_() {
     return false;
   }
 
-#ifdef USE_ESP_ADF
-  this->vad_instance_ = vad_create(VAD_MODE_4);
-#endif
-
   this->ring_buffer_ = RingBuffer::create(BUFFER_SIZE * sizeof(int16_t));
   if (this->ring_buffer_ == nullptr) {
     ESP_LOGW(TAG, "Could not allocate ring buffer");
@@ -131,6 +171,10 @@ void VoiceAssistant::clear_buffers_() {
   }
 
 #ifdef USE_SPEAKER
+  if (this->udp_audio_buffer_ != nullptr) {
+    this->udp_audio_buffer_->reset();
+  }
+
   if (this->speaker_ != nullptr) {
     if (this->speaker_buffer_ != nullptr) {
       memset(this->speaker_buffer_, 0, SPEAKER_BUFFER_SIZE);
@@ -153,13 +197,6 @@ void VoiceAssistant::deallocate_buffers_() {
     this->ring_buffer_ = nullptr;
   }
 
-#ifdef USE_ESP_ADF
-  if (this->vad_instance_ != nullptr) {
-    vad_destroy(this->vad_instance_);
-    this->vad_instance_ = nullptr;
-  }
-#endif
-
   ExternalRAMAllocator<int16_t> input_deallocator(ExternalRAMAllocator<int16_t>::ALLOW_FAILURE);
   input_deallocator.deallocate(this->input_buffer_, INPUT_BUFFER_SIZE);
   this->input_buffer_ = nullptr;
@@ -200,15 +237,19 @@ void VoiceAssistant::loop() {
       this->set_state_(State::IDLE, State::IDLE);
     }
     this->continuous_ = false;
+    this->continue_conversation_ = false;
+    this->pipeline_running_ = false;
+    this->cancel_follow_up_();
     this->signal_stop_();
     this->clear_buffers_();
     return;
   }
   switch (this->state_) {
     case State::IDLE: {
-      if (this->continuous_ && this->desired_state_ == State::IDLE) {
+      if ((this->continuous_ || this->continue_conversation_) && this->desired_state_ == State::IDLE) {
+        this->continue_conversation_ = false;
         this->idle_trigger_->trigger();
-#ifdef USE_ESP_ADF
+#ifdef USE_MICRO_WAKE_WORD_VAD
         if (this->use_wake_word_) {
           this->set_state_(State::START_MICROPHONE, State::WAIT_FOR_VAD);
         } else
@@ -244,7 +285,7 @@ void VoiceAssistant::loop() {
       }
       break;
     }
-#ifdef USE_ESP_ADF
+#ifdef USE_MICRO_WAKE_WORD_VAD
     case State::WAIT_FOR_VAD: {
       this->read_microphone_();
       ESP_LOGD(TAG, "Waiting for speech...");
@@ -252,60 +293,35 @@ void VoiceAssistant::loop() {
       break;
     }
     case State::WAITING_FOR_VAD: {
-      size_t bytes_read = this->read_microphone_();
-      if (bytes_read > 0) {
-        vad_state_t vad_state =
-            vad_process(this->vad_instance_, this->input_buffer_, SAMPLE_RATE_HZ, VAD_FRAME_LENGTH_MS);
-        if (vad_state == VAD_SPEECH) {
-          if (this->vad_counter_ < this->vad_threshold_) {
-            this->vad_counter_++;
-          } else {
-            ESP_LOGD(TAG, "VAD detected speech");
-            this->set_state_(State::START_PIPELINE, State::STREAMING_MICROPHONE);
+      // Keep buffering audio so the start of the speech is sent once the pipeline starts
+      this->read_microphone_();
 
-            // Reset for next time
-            this->vad_counter_ = 0;
-          }
-        } else {
-          if (this->vad_counter_ > 0) {
-            this->vad_counter_--;
-          }
-        }
+      // The VAD state only updates while micro_wake_word is detecting
+      const uint32_t now = millis();
+      if ((this->micro_wake_word_ == nullptr) || !this->micro_wake_word_->is_running() ||
+          (now - this->micro_wake_word_->get_vad_state_updated_ms() > VAD_STALE_MS)) {
+        ESP_LOGD(TAG, "VAD state isn't available; starting without waiting for speech");
+        this->set_state_(State::START_PIPELINE, State::STREAMING_MICROPHONE);
+        break;
+      }
+
+      if (this->micro_wake_word_->get_vad_state() &&
+          (now - this->micro_wake_word_->get_vad_state_changed_ms() >= this->vad_threshold_ * VAD_FRAME_MS)) {
+        ESP_LOGD(TAG, "VAD detected speech");
+        this->set_state_(State::START_PIPELINE, State::STREAMING_MICROPHONE);
       }
       break;
     }
 #endif
     case State::START_PIPELINE: {
       this->read_microphone_();
-      ESP_LOGD(TAG, "Requesting start...");
-      uint32_t flags = 0;
-      if (this->use_wake_word_)
-        flags |= api::enums::VOICE_ASSISTANT_REQUEST_USE_WAKE_WORD;
-      if (this->silence_detection_)
-        flags |= api::enums::VOICE_ASSISTANT_REQUEST_USE_VAD;
-
-      api::VoiceAssistantAudioSettings audio_settings;
-      audio_settings.noise_suppression_level = this->noise_suppression_level_;
-      audio_settings.auto_gain = this->auto_gain_;
-      audio_settings.volume_multiplier = this->volume_multiplier_;
-
-      api::VoiceAssistantRequest msg;
-      msg.start = true;
-      msg.conversation_id = this->conversation_id_;
-      msg.flags = flags;
-      msg.audio_settings = audio_settings;
-      msg.wake_word_phrase = this->wake_word_;
-      this->wake_word_ = "";
-
-      if (this->api_client_ == nullptr || !this->api_client_->send_voice_assistant_request(msg)) {
-        ESP_LOGW(TAG, "Could not request start");
-        this->error_trigger_->trigger("not-connected", "Could not request start");
+      if (!this->send_start_request_()) {
         this->continuous_ = false;
+        this->continue_conversation_ = false;
         this->set_state_(State::IDLE, State::IDLE);
         break;
       }
       this->set_state_(State::STARTING_PIPELINE);
-      this->set_timeout("reset-conversation_id", 5 * 60 * 1000, [this]() { this->conversation_id_ = ""; });
       break;
     }
     case State::STARTING_PIPELINE: {
@@ -315,6 +331,11 @@ void VoiceAssistant::loop() {
     case State::STREAMING_MICROPHONE: {
       this->read_microphone_();
       size_t available = this->ring_buffer_->available();
+      if ((this->response_ended_ms_ != 0) && (available >= SEND_BUFFER_SIZE)) {
+        ESP_LOGD(TAG, "Listening for the follow-up %" PRIu32 " ms after the response ended",
+                 millis() - this->response_ended_ms_);
+        this->response_ended_ms_ = 0;
+      }
       while (available >= SEND_BUFFER_SIZE) {
         size_t read_bytes = this->ring_buffer_->read((void *) this->send_buffer_, SEND_BUFFER_SIZE, 0);
         if (this->audio_mode_ == AUDIO_MODE_API) {
@@ -355,13 +376,16 @@ void VoiceAssistant::loop() {
       break;  // State changed by events
     }
     case State::STREAMING_RESPONSE: {
+      this->prepare_follow_up_();
       bool playing = false;
 #ifdef USE_SPEAKER
       if (this->speaker_ != nullptr) {
         ssize_t received_len = 0;
         if (this->audio_mode_ == AUDIO_MODE_UDP) {
-          if (this->speaker_buffer_index_ + RECEIVE_SIZE < SPEAKER_BUFFER_SIZE) {
-            received_len = this->socket_->read(this->speaker_buffer_ + this->speaker_buffer_index_, RECEIVE_SIZE);
+          // The receive task buffers the datagrams, so one loop iteration takes all that fits
+          if (this->speaker_buffer_index_ < SPEAKER_BUFFER_SIZE) {
+            received_len = this->udp_audio_buffer_->read(this->speaker_buffer_ + this->speaker_buffer_index_,
+                                                         SPEAKER_BUFFER_SIZE - this->speaker_buffer_index_);
             if (received_len > 0) {
               this->speaker_buffer_index_ += received_len;
               this->speaker_buffer_size_ += received_len;
@@ -372,7 +396,8 @@ void VoiceAssistant::loop() {
           }
         }
         // Build a small buffer of audio before sending to the speaker
-        bool end_of_stream = this->stream_ended_ && (this->audio_mode_ == AUDIO_MODE_API || received_len < 0);
+        bool end_of_stream = this->stream_ended_ && (this->audio_mode_ == AUDIO_MODE_API ||
+                                                     this->udp_audio_buffer_->available() == 0);
         if (this->speaker_bytes_received_ > RECEIVE_SIZE * 4 || end_of_stream)
           this->write_speaker_();
         if (this->wait_for_stream_end_) {
@@ -395,7 +420,7 @@ void VoiceAssistant::loop() {
       if (playing) {
         this->set_timeout("playing", 50, [this]() {
           this->cancel_timeout("speaker-timeout");
-          this->set_state_(State::IDLE, State::IDLE);
+          this->finish_response_();
 
           api::VoiceAssistantAnnounceFinished msg;
           msg.success = true;
@@ -405,6 +430,7 @@ void VoiceAssistant::loop() {
       break;
     }
     case State::RESPONSE_FINISHED: {
+      this->prepare_follow_up_();
 #ifdef USE_SPEAKER
       if (this->speaker_ != nullptr) {
         if (this->speaker_buffer_size_ > 0) {
@@ -415,6 +441,11 @@ void VoiceAssistant::loop() {
           break;
         }
         ESP_LOGD(TAG, "Speaker has finished outputting all audio");
+        if (this->audio_mode_ == AUDIO_MODE_UDP) {
+          ESP_LOGD(TAG, "UDP audio datagrams: %" PRIu32 " received, %" PRIu32 " dropped, %" PRIu32 " late",
+                   this->udp_datagrams_received_.exchange(0), this->udp_datagrams_dropped_.exchange(0),
+                   this->udp_datagrams_late_.exchange(0));
+        }
         this->speaker_->stop();
         this->cancel_timeout("speaker-timeout");
         this->cancel_timeout("playing");
@@ -427,7 +458,7 @@ void VoiceAssistant::loop() {
         this->tts_stream_end_trigger_->trigger();
       }
 #endif
-      this->set_state_(State::IDLE, State::IDLE);
+      this->finish_response_();
       break;
     }
     default:
@@ -452,8 +483,161 @@ void VoiceAssistant::write_speaker_() {
     }
   }
 }
+
+void VoiceAssistant::udp_receive_task_(void *params) {
+  VoiceAssistant *this_va = (VoiceAssistant *) params;
+  uint8_t datagram[RECEIVE_SIZE];
+  const int fd = this_va->socket_->get_fd();
+  ssize_t received_len;
+
+  while (true) {
+    if (!this_va->udp_audio_accepted_.load()) {
+      // Sleep until a pipeline starts
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      // Anything queued arrived while idle, after the previous response; it would otherwise play at the start of
+      // the next one
+      while ((received_len = this_va->socket_->read(datagram, RECEIVE_SIZE)) > 0) {
+        this_va->udp_datagrams_late_.fetch_add(1);
+      }
+      continue;
+    }
+
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(fd, &read_fds);
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = UDP_RECEIVE_TIMEOUT_MS * 1000;
+    if (select(fd + 1, &read_fds, nullptr, nullptr, &timeout) <= 0) {
+      continue;  // Timed out; check whether the pipeline is still running
+    }
+
+    // The socket is non-blocking, so drain every queued datagram
+    while ((received_len = this_va->socket_->read(datagram, RECEIVE_SIZE)) > 0) {
+      if (this_va->udp_audio_buffer_->free() < (size_t) received_len) {
+        this_va->udp_datagrams_dropped_.fetch_add(1);
+      } else {
+        this_va->udp_audio_buffer_->write(datagram, received_len);
+        this_va->udp_datagrams_received_.fetch_add(1);
+      }
+    }
+  }
+}
 #endif
 
+bool VoiceAssistant::send_start_request_() {
+  ESP_LOGD(TAG, "Requesting start...");
+  uint32_t flags = 0;
+  if (this->use_wake_word_)
+    flags |= api::enums::VOICE_ASSISTANT_REQUEST_USE_WAKE_WORD;
+  if (this->silence_detection_)
+    flags |= api::enums::VOICE_ASSISTANT_REQUEST_USE_VAD;
+
+  api::VoiceAssistantAudioSettings audio_settings;
+  audio_settings.noise_suppression_level = this->noise_suppression_level_;
+  audio_settings.auto_gain = this->auto_gain_;
+  audio_settings.volume_multiplier = this->volume_multiplier_;
+
+  api::VoiceAssistantRequest msg;
+  msg.start = true;
+  msg.conversation_id = this->conversation_id_;
+  msg.flags = flags;
+  msg.audio_settings = audio_settings;
+  msg.wake_word_phrase = this->wake_word_;
+  this->wake_word_ = "";
+
+  if (this->api_client_ == nullptr || !this->api_client_->send_voice_assistant_request(msg)) {
+    ESP_LOGW(TAG, "Could not request start");
+    this->error_trigger_->trigger("not-connected", "Could not request start");
+    return false;
+  }
+  this->set_timeout("reset-conversation_id", 5 * 60 * 1000, [this]() { this->conversation_id_ = ""; });
+  return true;
+}
+
+void VoiceAssistant::prepare_follow_up_() {
+  if (this->follow_up_requested_) {
+    if (this->mic_->is_running()) {
+      // Keep the microphone drained; what it captures now is the response playing back
+      this->read_microphone_();
+      this->ring_buffer_->reset();
+    }
+    return;
+  }
+  // Wait for the previous run to end, otherwise its run end event would stop the new one
+  if (!this->follow_up_ || this->pipeline_running_) {
+    return;
+  }
+  // Continuous wake word mode waits for a wake word anyway; it restarts from idle
+  if (this->use_wake_word_ || !this->allocate_buffers_()) {
+    return;
+  }
+
+  this->ring_buffer_->reset();
+  this->mic_->start();
+  if (!this->send_start_request_()) {
+    this->follow_up_ = false;
+    return;
+  }
+  ESP_LOGD(TAG, "Requested the follow-up pipeline while the response plays");
+  this->follow_up_requested_ = true;
+}
+
+void VoiceAssistant::cancel_follow_up_() {
+  if (this->follow_up_requested_ && this->mic_->is_running()) {
+    this->mic_->stop();
+  }
+  this->follow_up_ = false;
+  this->follow_up_requested_ = false;
+  this->follow_up_started_ = false;
+  this->follow_up_listening_ = false;
+}
+
+void VoiceAssistant::finish_response_() {
+  if (this->follow_up_) {
+    this->response_ended_ms_ = millis();
+  }
+
+  if (this->follow_up_started_) {
+    ESP_LOGD(TAG, "Response finished, streaming the follow-up");
+    this->audio_mode_ = this->follow_up_audio_mode_;
+    // The captured audio is the response playing back
+    this->ring_buffer_->reset();
+    this->continue_conversation_ = false;
+    this->set_state_(State::STREAMING_MICROPHONE, State::STREAMING_MICROPHONE);
+  } else if (this->follow_up_requested_) {
+    // start_streaming() moves on once Home Assistant answers
+    this->ring_buffer_->reset();
+    this->continue_conversation_ = false;
+    this->set_state_(State::STARTING_PIPELINE);
+  } else {
+    this->idle_after_response_();
+  }
+
+  if (this->follow_up_start_deferred_ && this->follow_up_requested_) {
+    this->follow_up_start_deferred_ = false;
+    this->start_trigger_->trigger();
+  }
+  if (this->follow_up_listening_) {
+    this->listening_trigger_->trigger();
+  }
+  this->follow_up_ = false;
+  this->follow_up_requested_ = false;
+  this->follow_up_started_ = false;
+  this->follow_up_listening_ = false;
+}
+
+bool VoiceAssistant::is_playing_response_() const {
+  return (this->state_ == State::STREAMING_RESPONSE) || (this->state_ == State::RESPONSE_FINISHED);
+}
+
+void VoiceAssistant::idle_after_response_() {
+  const bool continue_conversation = this->continue_conversation_;
+  this->set_state_(State::IDLE, State::IDLE);
+  this->continue_conversation_ = continue_conversation;
+}
+
 void VoiceAssistant::client_subscription(api::APIConnection *client, bool subscribe) {
   if (!subscribe) {
     if (this->api_client_ == nullptr || client != this->api_client_) {
@@ -512,6 +696,16 @@ static const LogString *voice_assistant_state_to_string(State state) {
 void VoiceAssistant::set_state_(State state) {
   State old_state = this->state_;
   this->state_ = state;
+  if (state == State::IDLE) {
+    // Going idle ends the conversation; only idle_after_response_() keeps it going
+    this->continue_conversation_ = false;
+  }
+#ifdef USE_SPEAKER
+  const bool was_accepted = this->udp_audio_accepted_.exchange(state != State::IDLE);
+  if (!was_accepted && (state != State::IDLE) && (this->udp_receive_task_handle_ != nullptr)) {
+    xTaskNotifyGive(this->udp_receive_task_handle_);
+  }
+#endif
   ESP_LOGD(TAG, "State changed from %s to %s", LOG_STR_ARG(voice_assistant_state_to_string(old_state)),
            LOG_STR_ARG(voice_assistant_state_to_string(state)));
 }
@@ -525,10 +719,17 @@ void VoiceAssistant::set_state_(State state, State desired_state) {
 void VoiceAssistant::failed_to_start() {
   ESP_LOGE(TAG, "Failed to start server. See Home Assistant logs for more details.");
   this->error_trigger_->trigger("failed-to-start", "Failed to start server. See Home Assistant logs for more details.");
+  this->continue_conversation_ = false;
   this->set_state_(State::STOP_MICROPHONE, State::IDLE);
 }
 
 void VoiceAssistant::start_streaming() {
+  if (this->follow_up_requested_ && this->is_playing_response_()) {
+    // The response still plays in the current mode; finish_response_() switches over
+    this->follow_up_audio_mode_ = AUDIO_MODE_API;
+    this->follow_up_started_ = true;
+    return;
+  }
   if (this->state_ != State::STARTING_PIPELINE) {
     this->signal_stop_();
     return;
@@ -545,13 +746,13 @@ void VoiceAssistant::start_streaming() {
 }
 
 void VoiceAssistant::start_streaming(struct sockaddr_storage *addr, uint16_t port) {
-  if (this->state_ != State::STARTING_PIPELINE) {
+  const bool follow_up = this->follow_up_requested_ && this->is_playing_response_();
+  if (!follow_up && (this->state_ != State::STARTING_PIPELINE)) {
     this->signal_stop_();
     return;
   }
 
   ESP_LOGD(TAG, "Client started, streaming microphone");
-  this->audio_mode_ = AUDIO_MODE_UDP;
 
   memcpy(&this->dest_addr_, addr, sizeof(this->dest_addr_));
   if (this->dest_addr_.ss_family == AF_INET) {
@@ -567,6 +768,14 @@ void VoiceAssistant::start_streaming(struct sockaddr_storage *addr, uint16_t por
     return;
   }
 
+  if (follow_up) {
+    // Streaming starts once the response finishes playing; until then the response keeps reading in its own mode
+    this->follow_up_audio_mode_ = AUDIO_MODE_UDP;
+    this->follow_up_started_ = true;
+    return;
+  }
+
+  this->audio_mode_ = AUDIO_MODE_UDP;
   if (this->mic_->is_running()) {
     this->set_state_(State::STREAMING_MICROPHONE, State::STREAMING_MICROPHONE);
   } else {
@@ -579,12 +788,14 @@ void VoiceAssistant::request_start(bool continuous, bool silence_detection) {
     ESP_LOGE(TAG, "No API client connected");
     this->set_state_(State::IDLE, State::IDLE);
     this->continuous_ = false;
+    this->continue_conversation_ = false;
     return;
   }
   if (this->state_ == State::IDLE) {
     this->continuous_ = continuous;
+    this->response_ended_ms_ = 0;
     this->silence_detection_ = silence_detection;
-#ifdef USE_ESP_ADF
+#ifdef USE_MICRO_WAKE_WORD_VAD
     if (this->use_wake_word_) {
       this->set_state_(State::START_MICROPHONE, State::WAIT_FOR_VAD);
     } else
@@ -597,6 +808,7 @@ void VoiceAssistant::request_start(bool continuous, bool silence_detection) {
 
 void VoiceAssistant::request_stop() {
   this->continuous_ = false;
+  this->continue_conversation_ = false;
 
   switch (this->state_) {
     case State::IDLE:
@@ -622,6 +834,10 @@ void VoiceAssistant::request_stop() {
       break;
     case State::STREAMING_RESPONSE:
     case State::RESPONSE_FINISHED:
+      if (this->follow_up_requested_) {
+        this->signal_stop_();
+      }
+      this->cancel_follow_up_();
       break;  // Let the incoming audio stream finish then it will go to idle.
   }
 }
@@ -642,6 +858,13 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
   switch (msg.event_type) {
     case api::enums::VOICE_ASSISTANT_RUN_START:
       ESP_LOGD(TAG, "Assist Pipeline running");
+      this->pipeline_running_ = true;
+      if (this->follow_up_requested_ && this->is_playing_response_()) {
+        // Not started as far as automations can tell until the response finishes playing
+        this->follow_up_start_deferred_ = true;
+        break;
+      }
+      this->follow_up_start_deferred_ = false;
       this->defer([this]() { this->start_trigger_->trigger(); });
       break;
     case api::enums::VOICE_ASSISTANT_WAKE_WORD_START:
@@ -653,6 +876,11 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
     }
     case api::enums::VOICE_ASSISTANT_STT_START:
       ESP_LOGD(TAG, "STT started");
+      if (this->follow_up_requested_ && this->is_playing_response_()) {
+        // Not listening until the response finishes playing
+        this->follow_up_listening_ = true;
+        break;
+      }
       this->defer([this]() { this->listening_trigger_->trigger(); });
       break;
     case api::enums::VOICE_ASSISTANT_STT_END: {
@@ -675,9 +903,12 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
       this->defer([this]() { this->intent_start_trigger_->trigger(); });
       break;
     case api::enums::VOICE_ASSISTANT_INTENT_END: {
+      this->continue_conversation_ = false;
       for (auto arg : msg.data) {
         if (arg.name == "conversation_id") {
           this->conversation_id_ = std::move(arg.value);
+        } else if (arg.name == "continue_conversation") {
+          this->continue_conversation_ = (arg.value == "1");
         }
       }
       this->defer([this]() { this->intent_end_trigger_->trigger(); });
@@ -725,18 +956,30 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
 #endif
         this->tts_end_trigger_->trigger(url);
       });
-      State new_state = this->local_output_ ? State::STREAMING_RESPONSE : State::IDLE;
-      this->set_state_(new_state, new_state);
+      if (this->local_output_) {
+        this->set_state_(State::STREAMING_RESPONSE, State::STREAMING_RESPONSE);
+      } else {
+        this->idle_after_response_();
+      }
+      // Listen for the reply as soon as the response finishes playing
+      this->follow_up_ = this->local_output_ && (this->continuous_ || this->continue_conversation_);
       break;
     }
     case api::enums::VOICE_ASSISTANT_RUN_END: {
       ESP_LOGD(TAG, "Assist Pipeline ended");
-      if (this->state_ == State::STARTING_PIPELINE) {
+      this->pipeline_running_ = false;
+      // A follow-up that ends before its deferred start trigger fired doesn't fire the end trigger either
+      const bool start_deferred = this->follow_up_start_deferred_;
+      this->follow_up_start_deferred_ = false;
+      if (this->follow_up_requested_ && this->is_playing_response_()) {
+        // The follow-up ended before the response finished; restart from idle once it does, if still continuing
+        this->cancel_follow_up_();
+      } else if (this->state_ == State::STARTING_PIPELINE) {
         // Pipeline ended before starting microphone
         this->set_state_(State::IDLE, State::IDLE);
       } else if (this->state_ == State::STREAMING_MICROPHONE) {
         this->ring_buffer_->reset();
-#ifdef USE_ESP_ADF
+#ifdef USE_MICRO_WAKE_WORD_VAD
         if (this->use_wake_word_) {
           // No need to stop the microphone since we didn't use the speaker
           this->set_state_(State::WAIT_FOR_VAD, State::WAITING_FOR_VAD);
@@ -749,7 +992,9 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
         // No TTS start event ("nevermind")
         this->set_state_(State::IDLE, State::IDLE);
       }
-      this->defer([this]() { this->end_trigger_->trigger(); });
+      if (!start_deferred) {
+        this->defer([this]() { this->end_trigger_->trigger(); });
+      }
       break;
     }
     case api::enums::VOICE_ASSISTANT_ERROR: {
@@ -774,7 +1019,14 @@ void VoiceAssistant::on_event(const api::VoiceAssistantEventResponse &msg) {
         return;
       }
       ESP_LOGE(TAG, "Error: %s - %s", code.c_str(), message.c_str());
-      if (this->state_ != State::IDLE) {
+      if (this->follow_up_requested_ && this->is_playing_response_()) {
+        // Only the follow-up failed; let the response finish playing
+        this->cancel_follow_up_();
+        this->continuous_ = false;
+        this->continue_conversation_ = false;
+      } else if (this->state_ != State::IDLE) {
+        this->cancel_follow_up_();
+        this->continue_conversation_ = false;
         this->signal_stop_();
         this->set_state_(State::STOP_MICROPHONE, State::IDLE);
       }
@@ -832,16 +1084,33 @@ void VoiceAssistant::on_audio(const api::VoiceAssistantAudio &msg) {
 }
 
 void VoiceAssistant::on_timer_event(const api::VoiceAssistantTimerEventResponse &msg) {
-  Timer timer = {
-      .id = msg.timer_id,
-      .name = msg.name,
-      .total_seconds = msg.total_seconds,
-      .seconds_left = msg.seconds_left,
-      .is_active = msg.is_active,
-  };
-  this->timers_[timer.id] = timer;
   ESP_LOGD(TAG, "Timer Event");
   ESP_LOGD(TAG, "  Type: %" PRId32, msg.event_type);
+
+  int index = this->find_timer_(msg.timer_id);
+  if (index < 0) {
+    if (this->timers_.size() >= MAX_TIMERS) {
+      ESP_LOGW(TAG, "Ignoring timer %s, already tracking %u timers", msg.timer_id.c_str(), MAX_TIMERS);
+      return;
+    }
+    index = this->timers_.size();
+    this->timers_.emplace_back();
+  } else {
+    this->timer_heap_remove_(index);
+  }
+
+  Timer &timer = this->timers_[index];
+  timer.id = msg.timer_id;
+  timer.name = msg.name;
+  timer.total_seconds = msg.total_seconds;
+  timer.seconds_left = msg.seconds_left;
+  timer.is_active = msg.is_active;
+  if (timer.is_active) {
+    this->timer_deadlines_ms_[index] = millis() + timer.seconds_left * 1000;
+    if (timer.seconds_left > 0) {
+      this->timer_heap_push_(index);
+    }
+  }
   ESP_LOGD(TAG, "  %s", timer.to_string().c_str());
 
   switch (msg.event_type) {
@@ -853,34 +1122,133 @@ void VoiceAssistant::on_timer_event(const api::VoiceAssistantTimerEventResponse
       break;
     case api::enums::VOICE_ASSISTANT_TIMER_CANCELLED:
       this->timer_cancelled_trigger_->trigger(timer);
-      this->timers_.erase(timer.id);
+      this->remove_timer_(index);
       break;
     case api::enums::VOICE_ASSISTANT_TIMER_FINISHED:
       this->timer_finished_trigger_->trigger(timer);
-      this->timers_.erase(timer.id);
+      this->remove_timer_(index);
+      break;
+  }
+
+  this->schedule_timer_tick_();
+}
+
+int VoiceAssistant::find_timer_(const std::string &id) const {
+  for (size_t i = 0; i < this->timers_.size(); ++i) {
+    if (this->timers_[i].id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void VoiceAssistant::remove_timer_(uint8_t index) {
+  this->timer_heap_remove_(index);
+
+  const uint8_t last = this->timers_.size() - 1;
+  if (index != last) {
+    // Move the last timer into the freed index and point its heap entry there
+    this->timers_[index] = std::move(this->timers_[last]);
+    this->timer_deadlines_ms_[index] = this->timer_deadlines_ms_[last];
+    for (uint8_t i = 0; i < this->timer_heap_size_; ++i) {
+      if (this->timer_heap_[i] == last) {
+        this->timer_heap_[i] = index;
+        break;
+      }
+    }
+  }
+  this->timers_.pop_back();
+}
+
+bool VoiceAssistant::timer_deadline_before_(uint8_t a, uint8_t b) const {
+  // Compares the difference so deadlines stay ordered across millis() rollover
+  return static_cast<int32_t>(this->timer_deadlines_ms_[a] - this->timer_deadlines_ms_[b]) < 0;
+}
+
+void VoiceAssistant::timer_heap_push_(uint8_t index) {
+  this->timer_heap_[this->timer_heap_size_] = index;
+  this->timer_heap_sift_up_(this->timer_heap_size_++);
+}
+
+void VoiceAssistant::timer_heap_remove_(uint8_t index) {
+  for (uint8_t position = 0; position < this->timer_heap_size_; ++position) {
+    if (this->timer_heap_[position] == index) {
+      this->timer_heap_[position] = this->timer_heap_[--this->timer_heap_size_];
+      if (position < this->timer_heap_size_) {
+        this->timer_heap_sift_up_(position);
+        this->timer_heap_sift_down_(position);
+      }
+      return;
+    }
+  }
+}
+
+void VoiceAssistant::timer_heap_sift_up_(uint8_t position) {
+  while (position > 0) {
+    const uint8_t parent = (position - 1) / 2;
+    if (!this->timer_deadline_before_(this->timer_heap_[position], this->timer_heap_[parent])) {
       break;
+    }
+    std::swap(this->timer_heap_[position], this->timer_heap_[parent]);
+    position = parent;
   }
+}
 
-  if (this->timers_.empty()) {
-    this->cancel_interval("timer-event");
-    this->timer_tick_running_ = false;
-  } else if (!this->timer_tick_running_) {
-    this->set_interval("timer-event", 1000, [this]() { this->timer_tick_(); });
-    this->timer_tick_running_ = true;
+void VoiceAssistant::timer_heap_sift_down_(uint8_t position) {
+  while (true) {
+    uint8_t earliest = position;
+    for (uint8_t child = 2 * position + 1; child <= 2 * position + 2; ++child) {
+      if ((child < this->timer_heap_size_) &&
+          this->timer_deadline_before_(this->timer_heap_[child], this->timer_heap_[earliest])) {
+        earliest = child;
+      }
+    }
+    if (earliest == position) {
+      break;
+    }
+    std::swap(this->timer_heap_[position], this->timer_heap_[earliest]);
+    position = earliest;
   }
 }
 
-void VoiceAssistant::timer_tick_() {
-  std::vector<Timer> res;
-  res.reserve(this->timers_.size());
-  for (auto &pair : this->timers_) {
-    auto &timer = pair.second;
-    if (timer.is_active && timer.seconds_left > 0) {
-      timer.seconds_left--;
+void VoiceAssistant::update_timers_seconds_left_() {
+  const uint32_t now = millis();
+  for (size_t i = 0; i < this->timers_.size(); ++i) {
+    Timer &timer = this->timers_[i];
+    if (timer.is_active) {
+      const int32_t remaining_ms = static_cast<int32_t>(this->timer_deadlines_ms_[i] - now);
+      timer.seconds_left = remaining_ms > 0 ? (remaining_ms + 999) / 1000 : 0;
     }
-    res.push_back(timer);
   }
-  this->timer_tick_trigger_->trigger(res);
+}
+
+void VoiceAssistant::schedule_timer_tick_() {
+  const uint32_t now = millis();
+
+  // Expired timers stay at 0 seconds left until Home Assistant reports them finished
+  while ((this->timer_heap_size_ > 0) &&
+         (static_cast<int32_t>(this->timer_deadlines_ms_[this->timer_heap_[0]] - now) <= 0)) {
+    this->timer_heap_remove_(this->timer_heap_[0]);
+  }
+
+  if (this->timer_heap_size_ == 0) {
+    this->cancel_timeout("timer-tick");
+    return;
+  }
+
+  // Computed from the deadline, so a late tick doesn't delay the following ones
+  const uint32_t remaining_ms = this->timer_deadlines_ms_[this->timer_heap_[0]] - now;
+  uint32_t delay_ms = remaining_ms % 1000;
+  if (delay_ms == 0) {
+    delay_ms = 1000;
+  }
+  this->set_timeout("timer-tick", delay_ms, [this]() { this->timer_tick_(); });
+}
+
+void VoiceAssistant::timer_tick_() {
+  this->update_timers_seconds_left_();
+  this->timer_tick_trigger_->trigger(this->timers_);
+  this->schedule_timer_tick_();
 }
 
 void VoiceAssistant::on_announce(const api::VoiceAssistantAnnounceRequest &msg) {
@@ -23,11 +23,11 @@
 #endif
 #include "esphome/components/socket/socket.h"
 
-#ifdef USE_ESP_ADF
-#include <esp_vad.h>
-#endif
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
-#include <unordered_map>
+#include <array>
+#include <atomic>
 #include <vector>
 
 namespace esphome {
@@ -38,6 +38,9 @@ namespace voice_assistant {
 static const uint32_t LEGACY_INITIAL_VERSION = 1;
 static const uint32_t LEGACY_SPEAKER_SUPPORT = 2;
 
+// Most timers tracked at once; Home Assistant timers beyond this are ignored
+static const uint8_t MAX_TIMERS = 8;
+
 enum VoiceAssistantFeature : uint32_t {
   FEATURE_VOICE_ASSISTANT = 1 << 0,
   FEATURE_SPEAKER = 1 << 1,
@@ -166,9 +169,9 @@ class VoiceAssistant : public Component {
   const Configuration &get_configuration();
 
   void set_use_wake_word(bool use_wake_word) { this->use_wake_word_ = use_wake_word; }
-#ifdef USE_ESP_ADF
+  /// @brief Sets how many 30 ms frames of continuous speech the micro_wake_word VAD must report before the pipeline
+  /// starts
   void set_vad_threshold(uint8_t vad_threshold) { this->vad_threshold_ = vad_threshold; }
-#endif
 
   void set_noise_suppression_level(uint8_t noise_suppression_level) {
     this->noise_suppression_level_ = noise_suppression_level;
@@ -206,9 +209,14 @@ class VoiceAssistant : public Component {
   Trigger<Timer> *get_timer_updated_trigger() const { return this->timer_updated_trigger_; }
   Trigger<Timer> *get_timer_cancelled_trigger() const { return this->timer_cancelled_trigger_; }
   Trigger<Timer> *get_timer_finished_trigger() const { return this->timer_finished_trigger_; }
-  Trigger<std::vector<Timer>> *get_timer_tick_trigger() const { return this->timer_tick_trigger_; }
+  Trigger<const std::vector<Timer> &> *get_timer_tick_trigger() const { return this->timer_tick_trigger_; }
   void set_has_timers(bool has_timers) { this->has_timers_ = has_timers; }
-  const std::unordered_map<std::string, Timer> &get_timers() const { return this->timers_; }
+
+  /// @brief Returns every timer, with each active timer's ``seconds_left`` computed from its deadline
+  const std::vector<Timer> &get_timers() {
+    this->update_timers_seconds_left_();
+    return this->timers_;
+  }
 
  protected:
   bool allocate_buffers_();
@@ -216,10 +224,27 @@ class VoiceAssistant : public Component {
   void deallocate_buffers_();
 
   int read_microphone_();
+
+  /// @brief Sends the request to start a pipeline
+  /// @return False if the API client couldn't send it
+  bool send_start_request_();
+
+  /// @brief While a response that should be followed up plays, starts the microphone and requests the next pipeline
+  /// once the current run has ended. Its audio is only sent after the response finishes playing.
+  void prepare_follow_up_();
+  /// @brief Abandons a follow-up requested during the response, stopping the microphone started for it
+  void cancel_follow_up_();
+  /// @brief Called when the response finishes playing; streams the follow-up if it was requested, else goes idle
+  void finish_response_();
+  bool is_playing_response_() const;
+  /// @brief Goes idle while keeping a continued conversation, so the IDLE state starts listening for the reply
+  void idle_after_response_();
+
   void set_state_(State state);
   void set_state_(State state, State desired_state);
   void signal_stop_();
 
+  // Once the UDP receive task is running, it owns every read from the socket. Sends stay on the main loop.
   std::unique_ptr<socket::Socket> socket_ = nullptr;
   struct sockaddr_storage dest_addr_;
 
@@ -246,20 +271,60 @@ class VoiceAssistant : public Component {
 
   api::APIConnection *api_client_{nullptr};
 
-  std::unordered_map<std::string, Timer> timers_;
+  // Timers reported by Home Assistant. Reserved to MAX_TIMERS entries, so it never reallocates. A paused timer's
+  // ``seconds_left`` is as reported; an active timer's is only current after update_timers_seconds_left_().
+  std::vector<Timer> timers_;
+  // Deadline (from millis()) of each active timer, indexed like timers_
+  std::array<uint32_t, MAX_TIMERS> timer_deadlines_ms_{};
+  // Min-heap of the indices of active timers whose deadline hasn't passed, ordered by deadline
+  std::array<uint8_t, MAX_TIMERS> timer_heap_{};
+  uint8_t timer_heap_size_{0};
+
+  /// @brief Returns the index of the timer with the given id, or -1 if it isn't tracked
+  int find_timer_(const std::string &id) const;
+  /// @brief Removes the timer at the index, moving the last timer into its place
+  void remove_timer_(uint8_t index);
+
+  bool timer_deadline_before_(uint8_t a, uint8_t b) const;
+  void timer_heap_push_(uint8_t index);
+  /// @brief Removes the timer index from the heap, if present
+  void timer_heap_remove_(uint8_t index);
+  void timer_heap_sift_up_(uint8_t position);
+  void timer_heap_sift_down_(uint8_t position);
+
+  /// @brief Sets every active timer's ``seconds_left`` from its deadline, rounding up to whole seconds
+  void update_timers_seconds_left_();
+
+  /// @brief Drops expired timers from the heap and schedules the next tick. Ticks land on the whole second boundaries
+  /// of the timer with the nearest deadline, so its ``seconds_left`` changes exactly when the tick runs, and the last
+  /// tick lands on its deadline. Nothing is scheduled while no timer is counting down.
+  void schedule_timer_tick_();
   void timer_tick_();
+
   Trigger<Timer> *timer_started_trigger_ = new Trigger<Timer>();
   Trigger<Timer> *timer_finished_trigger_ = new Trigger<Timer>();
   Trigger<Timer> *timer_updated_trigger_ = new Trigger<Timer>();
   Trigger<Timer> *timer_cancelled_trigger_ = new Trigger<Timer>();
-  Trigger<std::vector<Timer>> *timer_tick_trigger_ = new Trigger<std::vector<Timer>>();
+  Trigger<const std::vector<Timer> &> *timer_tick_trigger_ = new Trigger<const std::vector<Timer> &>();
   bool has_timers_{false};
-  bool timer_tick_running_{false};
 
   microphone::Microphone *mic_{nullptr};
 #ifdef USE_SPEAKER
   void write_speaker_();
   speaker::Speaker *speaker_{nullptr};
+
+  /// @brief Drains TTS datagrams from the UDP socket into udp_audio_buffer_, independent of the main loop's timing.
+  /// Blocks in select() while a pipeline runs and sleeps on a task notification while idle.
+  static void udp_receive_task_(void *params);
+  TaskHandle_t udp_receive_task_handle_{nullptr};
+  std::unique_ptr<RingBuffer> udp_audio_buffer_;
+  // Datagrams are only buffered while the voice assistant isn't idle
+  std::atomic<bool> udp_audio_accepted_{false};
+  // Counted by the receive task; logged and reset when a response finishes
+  std::atomic<uint32_t> udp_datagrams_received_{0};
+  std::atomic<uint32_t> udp_datagrams_dropped_{0};  // The buffer was full
+  std::atomic<uint32_t> udp_datagrams_late_{0};     // Arrived while idle
+
   uint8_t *speaker_buffer_;
   size_t speaker_buffer_index_{0};
   size_t speaker_buffer_size_{0};
@@ -279,11 +344,7 @@ class VoiceAssistant : public Component {
 
   HighFrequencyLoopRequester high_freq_;
 
-#ifdef USE_ESP_ADF
-  vad_handle_t vad_instance_;
   uint8_t vad_threshold_{5};
-  uint8_t vad_counter_{0};
-#endif
   std::unique_ptr<RingBuffer> ring_buffer_;
 
   bool use_wake_word_;
@@ -297,10 +358,29 @@ class VoiceAssistant : public Component {
   bool continuous_{false};
   bool silence_detection_;
 
+  // Home Assistant expects a reply to the response, sent in the intent end event
+  bool continue_conversation_{false};
+  bool pipeline_running_{false};
+
+  // Set when a response starts that should be followed by listening for a reply
+  bool follow_up_{false};
+  // The follow-up pipeline was requested while the response plays
+  bool follow_up_requested_{false};
+  // Home Assistant accepted the follow-up pipeline; audio flows once the response ends
+  bool follow_up_started_{false};
+  // STT started for the follow-up while the response was playing; the listening trigger waits for it to end
+  bool follow_up_listening_{false};
+  // The follow-up pipeline's run started while the response was playing; the start trigger waits for it to end
+  bool follow_up_start_deferred_{false};
+  // Time the followed up response finished playing; used to log how long until audio streams again
+  uint32_t response_ended_ms_{0};
+
   State state_{State::IDLE};
   State desired_state_{State::IDLE};
 
   AudioMode audio_mode_{AUDIO_MODE_UDP};
+  // Mode Home Assistant chose for a follow-up accepted while the response plays; applied once the response finishes
+  AudioMode follow_up_audio_mode_{AUDIO_MODE_UDP};
   bool udp_socket_running_{false};
   bool start_udp_socket_();
 
@@ -4,7 +4,7 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome import pins
 from esphome import automation, core, external_files
-from esphome.components import i2c
+from esphome.components import i2c, i2c_scheduler
 from esphome.const import (
     CONF_ID,
     CONF_ON_ERROR,
@@ -18,6 +18,7 @@ from esphome.core import HexInt
 
 CODEOWNERS = ["@kbx81"]
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["i2c_scheduler"]
 
 CONF_FIRMWARE = "firmware"
 CONF_MD5 = "md5"
@@ -28,7 +29,9 @@ CONF_ON_PROGRESS = "on_progress"
 DOMAIN = "voice_kit"
 
 voice_kit_ns = cg.esphome_ns.namespace("voice_kit")
-VoiceKit = voice_kit_ns.class_("VoiceKit", cg.Component, i2c.I2CDevice)
+VoiceKit = voice_kit_ns.class_(
+    "VoiceKit", cg.Component, i2c.I2CDevice, i2c_scheduler.ScheduledDevice
+)
 VoiceKitFlashAction = voice_kit_ns.class_("VoiceKitFlashAction", automation.Action)
 
 PipelineStages = voice_kit_ns.enum("PipelineStages")
@@ -155,6 +158,7 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
+    await i2c_scheduler.register_scheduled_device(var, config)
 
     pin = await cg.gpio_pin_expression(config[CONF_RESET_PIN])
     cg.add(var.set_reset_pin(pin))
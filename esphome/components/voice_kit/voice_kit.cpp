@@ -22,17 +22,22 @@ void VoiceKit::setup() {
   this->reset_pin_->digital_write(false);
   // Wait for XMOS to boot...
   this->set_timeout(3000, [this]() {
-    if (!this->dfu_get_version_()) {
-      ESP_LOGE(TAG, "Communication with Voice Kit failed");
-      this->mark_failed();
-    } else if (!this->versions_match_() && this->firmware_bin_is_valid_()) {
-      ESP_LOGW(TAG, "Expected XMOS version: %u.%u.%u; found: %u.%u.%u. Updating...", this->firmware_bin_version_major_,
-               this->firmware_bin_version_minor_, this->firmware_bin_version_patch_, this->firmware_version_major_,
-               this->firmware_version_minor_, this->firmware_version_patch_);
-      this->start_dfu_update();
-    } else {
-      this->write_pipeline_stages();
-    }
+    this->submit_i2c_(
+        i2c_scheduler::Priority::BULK, [this]() { return this->dfu_get_version_(); },
+        [this](bool success) {
+          if (!success) {
+            ESP_LOGE(TAG, "Communication with Voice Kit failed");
+            this->mark_failed();
+          } else if (!this->versions_match_() && this->firmware_bin_is_valid_()) {
+            ESP_LOGW(TAG, "Expected XMOS version: %u.%u.%u; found: %u.%u.%u. Updating...",
+                     this->firmware_bin_version_major_, this->firmware_bin_version_minor_,
+                     this->firmware_bin_version_patch_, this->firmware_version_major_, this->firmware_version_minor_,
+                     this->firmware_version_patch_);
+            this->start_dfu_update();
+          } else {
+            this->write_pipeline_stages();
+          }
+        });
   });
 }
 
@@ -51,7 +56,9 @@ void VoiceKit::loop() {
     case UPDATE_IN_PROGRESS:
     case UPDATE_REBOOT_PENDING:
     case UPDATE_VERIFY_NEW_VERSION:
-      this->dfu_update_status_ = this->dfu_update_send_block_();
+      if (!this->dfu_transaction_pending_) {
+        this->submit_dfu_transaction_();
+      }
       break;
 
     case UPDATE_COMMUNICATION_ERROR:
@@ -71,6 +78,18 @@ void VoiceKit::loop() {
 }
 
 uint8_t VoiceKit::read_vnr() {
+  if (!this->vnr_read_pending_) {
+    this->vnr_read_pending_ = true;
+    if (!this->submit_i2c_(
+            i2c_scheduler::Priority::TELEMETRY, [this]() { return this->read_vnr_(); },
+            [this](bool success) { this->vnr_read_pending_ = false; })) {
+      this->vnr_read_pending_ = false;
+    }
+  }
+  return this->vnr_;
+}
+
+bool VoiceKit::read_vnr_() {
   const uint8_t vnr_req[] = {CONFIGURATION_SERVICER_RESID,
                              CONFIGURATION_SERVICER_RESID_VNR_VALUE | CONFIGURATION_COMMAND_READ_BIT, 2};
   uint8_t vnr_resp[2];
@@ -78,17 +97,30 @@ uint8_t VoiceKit::read_vnr() {
   auto error_code = this->write(vnr_req, sizeof(vnr_req));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Request status failed");
-    return 0;
+    return false;
   }
   error_code = this->read(vnr_resp, sizeof(vnr_resp));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Failed to read VNR");
-    return 0;
+    return false;
   }
-  return vnr_resp[1];
+  this->vnr_ = vnr_resp[1];
+  return true;
 }
 
 PipelineStages VoiceKit::read_pipeline_stage(MicrophoneChannels channel) {
+  if (!this->pipeline_stage_read_pending_[channel]) {
+    this->pipeline_stage_read_pending_[channel] = true;
+    if (!this->submit_i2c_(
+            i2c_scheduler::Priority::TELEMETRY, [this, channel]() { return this->read_pipeline_stage_(channel); },
+            [this, channel](bool success) { this->pipeline_stage_read_pending_[channel] = false; })) {
+      this->pipeline_stage_read_pending_[channel] = false;
+    }
+  }
+  return this->pipeline_stages_[channel];
+}
+
+bool VoiceKit::read_pipeline_stage_(MicrophoneChannels channel) {
   uint8_t channel_register = CONFIGURATION_SERVICER_RESID_CHANNEL_0_PIPELINE_STAGE | CONFIGURATION_COMMAND_READ_BIT;
   if (channel == MICROPHONE_CHANNEL_1) {
     channel_register = CONFIGURATION_SERVICER_RESID_CHANNEL_1_PIPELINE_STAGE | CONFIGURATION_COMMAND_READ_BIT;
@@ -101,33 +133,50 @@ PipelineStages VoiceKit::read_pipeline_stage(MicrophoneChannels channel) {
   auto error_code = this->write(stage_req, sizeof(stage_req));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Failed to read stage");
+    return false;
   }
   error_code = this->read(stage_resp, sizeof(stage_resp));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Failed to read stage");
+    return false;
   }
 
-  return static_cast<PipelineStages>(stage_resp[1]);
+  this->pipeline_stages_[channel] = static_cast<PipelineStages>(stage_resp[1]);
+  return true;
 }
 
 void VoiceKit::write_pipeline_stages() {
+  const PipelineStages channel_0_stage = this->channel_0_stage_;
+  const PipelineStages channel_1_stage = this->channel_1_stage_;
+  this->submit_i2c_(i2c_scheduler::Priority::URGENT, [this, channel_0_stage, channel_1_stage]() {
+    return this->write_pipeline_stages_(channel_0_stage, channel_1_stage);
+  });
+}
+
+bool VoiceKit::write_pipeline_stages_(PipelineStages channel_0_stage, PipelineStages channel_1_stage) {
+  bool success = true;
+
   // Write channel 0 stage
   uint8_t stage_set[] = {CONFIGURATION_SERVICER_RESID, CONFIGURATION_SERVICER_RESID_CHANNEL_0_PIPELINE_STAGE, 1,
-                               this->channel_0_stage_};
+                         channel_0_stage};
 
   auto error_code = this->write(stage_set, sizeof(stage_set));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Failed to write chanenl 0 stage");
+    success = false;
   }
 
   // Write channel 1 stage
   stage_set[1] = CONFIGURATION_SERVICER_RESID_CHANNEL_1_PIPELINE_STAGE;
-  stage_set[3] = this->channel_1_stage_;
+  stage_set[3] = channel_1_stage;
 
   error_code = this->write(stage_set, sizeof(stage_set));
   if (error_code != i2c::ERROR_OK) {
     ESP_LOGE(TAG, "Failed to write channel 1 stage");
+    success = false;
   }
+
+  return success;
 }
 
 void VoiceKit::start_dfu_update() {
@@ -142,17 +191,74 @@ void VoiceKit::start_dfu_update() {
   this->state_callback_.call(DFU_START, 0, UPDATE_OK);
 #endif
 
-  if (!this->dfu_set_alternate_()) {
-    ESP_LOGE(TAG, "Set alternate request failed");
+  this->dfu_transaction_pending_ = true;
+  if (!this->submit_i2c_(
+          i2c_scheduler::Priority::BULK, [this]() { return this->dfu_set_alternate_(); },
+          [this](bool success) {
+            this->dfu_transaction_pending_ = false;
+            if (!success) {
+              ESP_LOGE(TAG, "Set alternate request failed");
+              this->dfu_update_status_ = UPDATE_COMMUNICATION_ERROR;
+              return;
+            }
+
+            this->bytes_written_ = 0;
+            this->bytes_reported_ = 0;
+            this->last_progress_ = 0;
+            this->last_progress_report_ms_ = 0;
+            this->last_ready_ = millis();
+            this->update_start_time_ = millis();
+            // loop() sends the blocks from here
+            this->dfu_update_status_ = UPDATE_IN_PROGRESS;
+          })) {
+    this->dfu_transaction_pending_ = false;
     this->dfu_update_status_ = UPDATE_COMMUNICATION_ERROR;
+  }
+}
+
+void VoiceKit::submit_dfu_transaction_() {
+  this->dfu_transaction_pending_ = true;
+  if (!this->submit_i2c_(
+          i2c_scheduler::Priority::BULK,
+          [this]() {
+            this->dfu_next_status_ = this->dfu_update_send_block_();
+            return (this->dfu_next_status_ == UPDATE_OK) || (this->dfu_next_status_ == UPDATE_IN_PROGRESS) ||
+                   (this->dfu_next_status_ == UPDATE_REBOOT_PENDING) ||
+                   (this->dfu_next_status_ == UPDATE_VERIFY_NEW_VERSION);
+          },
+          [this](bool success) {
+            this->dfu_transaction_pending_ = false;
+            const VoiceKitUpdaterStatus previous_status = this->dfu_update_status_;
+            this->dfu_update_status_ = this->dfu_next_status_;
+            this->report_dfu_progress_();
+
+            if ((previous_status == UPDATE_VERIFY_NEW_VERSION) && (this->dfu_update_status_ == UPDATE_OK)) {
+#ifdef USE_VOICE_KIT_STATE_CALLBACK
+              this->state_callback_.call(DFU_COMPLETE, 100.0f, UPDATE_OK);
+#endif
+              this->write_pipeline_stages();
+            }
+          })) {
+    // The bulk queue is full; loop() tries again
+    this->dfu_transaction_pending_ = false;
+  }
+}
+
+void VoiceKit::report_dfu_progress_() {
+  if (this->bytes_reported_ == this->bytes_written_) {
     return;
   }
 
-  this->bytes_written_ = 0;
-  this->last_progress_ = 0;
-  this->last_ready_ = millis();
-  this->update_start_time_ = millis();
-  this->dfu_update_status_ = this->dfu_update_send_block_();
+  uint32_t now = millis();
+  if ((now - this->last_progress_report_ms_ > 1000) or (this->bytes_written_ == this->firmware_bin_length_)) {
+    this->last_progress_report_ms_ = now;
+    this->bytes_reported_ = this->bytes_written_;
+    float percentage = this->bytes_written_ * 100.0f / this->firmware_bin_length_;
+    ESP_LOGD(TAG, "Progress: %0.1f%%", percentage);
+#ifdef USE_VOICE_KIT_STATE_CALLBACK
+    this->state_callback_.call(DFU_IN_PROGRESS, percentage, UPDATE_IN_PROGRESS);
+#endif
+  }
 }
 
 VoiceKitUpdaterStatus VoiceKit::dfu_update_send_block_() {
@@ -185,16 +291,6 @@ VoiceKitUpdaterStatus VoiceKit::dfu_update_send_block_() {
       }
       this->bytes_written_ += bufsize;
     }
-
-    uint32_t now = millis();
-    if ((now - this->last_progress_ > 1000) or (this->bytes_written_ == this->firmware_bin_length_)) {
-      this->last_progress_ = now;
-      float percentage = this->bytes_written_ * 100.0f / this->firmware_bin_length_;
-      ESP_LOGD(TAG, "Progress: %0.1f%%", percentage);
-#ifdef USE_VOICE_KIT_STATE_CALLBACK
-      this->state_callback_.call(DFU_IN_PROGRESS, percentage, UPDATE_IN_PROGRESS);
-#endif
-    }
     return UPDATE_IN_PROGRESS;
   } else {  // writing the main payload is done; work out what to do next
     switch (this->dfu_update_status_) {
@@ -237,10 +333,6 @@ VoiceKitUpdaterStatus VoiceKit::dfu_update_send_block_() {
           return UPDATE_FAILED;
         }
         ESP_LOGI(TAG, "Update complete");
-#ifdef USE_VOICE_KIT_STATE_CALLBACK
-        this->state_callback_.call(DFU_COMPLETE, 100.0f, UPDATE_OK);
-#endif
-        this->write_pipeline_stages();
         return UPDATE_OK;
 
       default:
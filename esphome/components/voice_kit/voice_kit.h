@@ -1,6 +1,7 @@
 #pragma once
 
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/components/i2c_scheduler/i2c_scheduler.h"
 #include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/core/defines.h"
@@ -120,7 +121,9 @@ enum DFUAutomationState {
   DFU_ERROR,
 };
 
-class VoiceKit : public Component, public i2c::I2CDevice {
+// Every XMOS transaction runs on the I2C scheduler's task: pipeline stage writes are urgent, firmware update steps are
+// bulk, and the VNR and pipeline stage reads are telemetry. The update sends one transaction at a time from loop().
+class VoiceKit : public Component, public i2c::I2CDevice, public i2c_scheduler::ScheduledDevice {
  public:
   void setup() override;
   bool can_proceed() override {
@@ -152,15 +155,28 @@ class VoiceKit : public Component, public i2c::I2CDevice {
   void set_channel_0_stage(PipelineStages channel_0_stage) { this->channel_0_stage_ = channel_0_stage; }
   void set_channel_1_stage(PipelineStages channel_1_stage) { this->channel_1_stage_ = channel_1_stage; }
 
+  /// @brief Queues writing the configured pipeline stages
   void write_pipeline_stages();
+
+  /// @brief Returns the most recently read VNR value (0 before the first read) and queues a read to refresh it
   uint8_t read_vnr();
 
+  /// @brief Returns the most recently read stage of the channel and queues a read to refresh it
   PipelineStages read_pipeline_stage(MicrophoneChannels channel);
 
  protected:
 #ifdef USE_VOICE_KIT_STATE_CALLBACK
   CallbackManager<void(DFUAutomationState, float, VoiceKitUpdaterStatus)> state_callback_{};
 #endif
+  /// @brief Queues the next step of the firmware update; its completion updates dfu_update_status_
+  void submit_dfu_transaction_();
+  /// @brief Logs and reports the update's progress at most once a second
+  void report_dfu_progress_();
+
+  // These run on the I2C scheduler task, so they only access the bus and the device's own state
+  bool read_vnr_();
+  bool read_pipeline_stage_(MicrophoneChannels channel);
+  bool write_pipeline_stages_(PipelineStages channel_0_stage, PipelineStages channel_1_stage);
   VoiceKitUpdaterStatus dfu_update_send_block_();
   uint32_t load_buf_(uint8_t *buf, const uint8_t max_len, const uint32_t offset);
   bool firmware_bin_is_valid_() { return this->firmware_bin_ != nullptr && this->firmware_bin_length_; }
@@ -192,8 +208,18 @@ class VoiceKit : public Component, public i2c::I2CDevice {
   uint8_t firmware_version_minor_{0};
   uint8_t firmware_version_patch_{0};
 
+  uint8_t vnr_{0};
+  PipelineStages pipeline_stages_[2]{PIPELINE_STAGE_NONE, PIPELINE_STAGE_NONE};
+  bool vnr_read_pending_{false};
+  bool pipeline_stage_read_pending_[2]{false, false};
+
+  bool dfu_transaction_pending_{false};
+  VoiceKitUpdaterStatus dfu_next_status_{UPDATE_OK};  // Set by the pending update transaction
+
   uint32_t bytes_written_{0};
+  uint32_t bytes_reported_{0};
   uint32_t last_progress_{0};
+  uint32_t last_progress_report_ms_{0};
   uint32_t last_ready_{0};
   uint32_t status_last_read_ms_{0};
   uint32_t update_start_time_{0};